@@ -12,14 +12,64 @@
 #ifndef SPDLOG_COMPILED_LIB
     #define SPDLOG_COMPILED_LIB
 #endif
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
 #include <spdlog/logger.h>
 #include <spdlog/spdlog.h>
+#include <spdlog/async_logger.h>
+#include <spdlog/details/periodic_worker.h>
+#include <spdlog/details/thread_pool.h>
 #include "logger_config.h"
 #include "simple_console_logger.h"
 
+/**
+ * @brief 编译期日志级别.
+ * 
+ * @details 低于该级别的日志宏(LTrace ... LCritical)展开为 (void)0，参数不会被求值.
+ * @details 取值与 SPDLOG_LEVEL_* 一致，例如编译时指定 -DIC_LOG_ACTIVE_LEVEL=2 (即 IC_LOG_LEVEL_INFO)，
+ *          则 LTrace、LDebug 不产生任何代码.
+ */
+#define IC_LOG_LEVEL_TRACE    SPDLOG_LEVEL_TRACE
+#define IC_LOG_LEVEL_DEBUG    SPDLOG_LEVEL_DEBUG
+#define IC_LOG_LEVEL_INFO     SPDLOG_LEVEL_INFO
+#define IC_LOG_LEVEL_WARN     SPDLOG_LEVEL_WARN
+#define IC_LOG_LEVEL_ERROR    SPDLOG_LEVEL_ERROR
+#define IC_LOG_LEVEL_CRITICAL SPDLOG_LEVEL_CRITICAL
+#define IC_LOG_LEVEL_OFF      SPDLOG_LEVEL_OFF
+
+#ifndef IC_LOG_ACTIVE_LEVEL
+    #define IC_LOG_ACTIVE_LEVEL IC_LOG_LEVEL_TRACE
+#endif
+
 namespace ic {
 namespace log {
 
+/**
+ * @brief 统计信息快照，见 Logger::GetStats().
+ */
+struct LoggerStats {
+    struct SinkStats {
+        /** sink名称，如 console、daily:logs/daily.txt、rotating:logs/log.txt */
+        std::string name;
+        /** 写入字节数、写入次数、刷新次数和耗时 */
+        spdlog::details::sink_stats stats;
+    };
+
+    /** 是否为异步模式(queue 仅在异步模式下有效) */
+    bool async = false;
+    /** 异步队列：当前深度、丢弃条数，开启 telemetry 时还有入队/出队条数、最大深度和延迟分布 */
+    spdlog::details::thread_pool_stats queue;
+    std::vector<SinkStats> sinks;
+
+    /**
+     * @brief 格式化为一行文本(延迟单位为微秒).
+     */
+    std::string ToString() const;
+};
+
 class Logger {
 public:
     Logger();
@@ -45,9 +95,54 @@ public:
         return logger;
     }
 
+    /**
+     * @brief 热路径使用：返回裸指针，不增减引用计数.
+     * 
+     * @details 指针在 Logger 析构(程序退出)前一直有效.
+     */
+    static spdlog::logger* GetRawLogger() {
+        spdlog::logger* raw_logger = s_raw_logger.load(std::memory_order_acquire);
+        return raw_logger ? raw_logger : GetInstance().logger.get();
+    }
+
+    /**
+     * @brief 热路径使用：detailed_min 的缓存，在 SetConfig() 和 Logger 构造时更新.
+     */
+    static spdlog::level::level_enum GetDetailedMin() {
+        return s_detailed_min.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 获取异步队列和各个sink的统计信息快照(可在任意线程调用).
+     */
+    LoggerStats GetStats() const;
+
+    /**
+     * @brief 限时关闭(如收到 SIGTERM 后调用)：停止接收新日志，在 timeout 内写完队列中的日志，
+     *        超时仍未写入的日志被丢弃，然后刷新所有sink，并将日志文件同步(fsync)到磁盘.
+     * 
+     * @details 异步模式下 timeout 之后最多再等待正在写入的一批日志；刷新和同步不计入 timeout.
+     * @details 之后的日志调用不再输出(异步模式下计入丢弃条数). 重复调用只返回第一次的结果.
+     * @details 有日志丢失时，在同步之前向各个sink写入一条 warning 日志说明丢失条数.
+     * 
+     * @return 丢失的日志条数：运行期间因队列满被丢弃的 + 关闭时未能写入的(同步模式为0).
+     */
+    size_t Shutdown(std::chrono::milliseconds timeout);
+
 private:
+    /** 异步模式下的后台线程池(同步模式为空)，须先于 logger 声明，以便 logger 先析构 */
+    std::shared_ptr<spdlog::details::thread_pool> thread_pool;
     std::shared_ptr<spdlog::logger> logger;
+    /** 与 logger->sinks() 一一对应 */
+    std::vector<std::string> sink_names;
+    /** 定期输出统计信息(stats_every > 0)，须在 logger 之后声明，以便先析构 */
+    std::unique_ptr<spdlog::details::periodic_worker> stats_worker;
+    /** Shutdown() 已调用及其结果 */
+    std::atomic<bool> shut_down{false};
+    size_t shutdown_lost = 0;
     static std::shared_ptr<LoggerConfig> s_config;
+    static std::atomic<spdlog::logger*> s_raw_logger;
+    static std::atomic<spdlog::level::level_enum> s_detailed_min;
 };
 
 } // namespace log
@@ -76,13 +171,40 @@ private:
  *  (4) std::string err_msg = "invalid token";
  *      LError("Access denied. Error message: {}", err_msg);
  * 
+ * 编译期过滤：
+ *   低于 IC_LOG_ACTIVE_LEVEL 的宏展开为 (void)0，见上方 IC_LOG_ACTIVE_LEVEL 的说明.
+ * 
  **********************************************************************************/
-#define LTrace(...)    __IC_LOG_VFUNC(_IC_LOG_LTrace, __VA_ARGS__)
-#define LDebug(...)    __IC_LOG_VFUNC(_IC_LOG_LDebug, __VA_ARGS__)
-#define LInfo(...)     __IC_LOG_VFUNC(_IC_LOG_LInfo, __VA_ARGS__)
-#define LWarn(...)     __IC_LOG_VFUNC(_IC_LOG_LWarn, __VA_ARGS__)
-#define LError(...)    __IC_LOG_VFUNC(_IC_LOG_LError, __VA_ARGS__)
-#define LCritical(...) __IC_LOG_VFUNC(_IC_LOG_LCritical, __VA_ARGS__)
+#if IC_LOG_ACTIVE_LEVEL <= IC_LOG_LEVEL_TRACE
+    #define LTrace(...)    __IC_LOG_VFUNC(_IC_LOG_LTrace, __VA_ARGS__)
+#else
+    #define LTrace(...)    (void)0
+#endif
+#if IC_LOG_ACTIVE_LEVEL <= IC_LOG_LEVEL_DEBUG
+    #define LDebug(...)    __IC_LOG_VFUNC(_IC_LOG_LDebug, __VA_ARGS__)
+#else
+    #define LDebug(...)    (void)0
+#endif
+#if IC_LOG_ACTIVE_LEVEL <= IC_LOG_LEVEL_INFO
+    #define LInfo(...)     __IC_LOG_VFUNC(_IC_LOG_LInfo, __VA_ARGS__)
+#else
+    #define LInfo(...)     (void)0
+#endif
+#if IC_LOG_ACTIVE_LEVEL <= IC_LOG_LEVEL_WARN
+    #define LWarn(...)     __IC_LOG_VFUNC(_IC_LOG_LWarn, __VA_ARGS__)
+#else
+    #define LWarn(...)     (void)0
+#endif
+#if IC_LOG_ACTIVE_LEVEL <= IC_LOG_LEVEL_ERROR
+    #define LError(...)    __IC_LOG_VFUNC(_IC_LOG_LError, __VA_ARGS__)
+#else
+    #define LError(...)    (void)0
+#endif
+#if IC_LOG_ACTIVE_LEVEL <= IC_LOG_LEVEL_CRITICAL
+    #define LCritical(...) __IC_LOG_VFUNC(_IC_LOG_LCritical, __VA_ARGS__)
+#else
+    #define LCritical(...) (void)0
+#endif
 
 
 /***********************************************************************************
@@ -94,52 +216,30 @@ private:
 #define __IC_LOG__HELPER_FUNCTION_REGION
 
 /**
- * @brief 内部命名空间，仅供当前文件使用
- */
-namespace ic {
-namespace log {
-namespace _internal {
-
-/**
- * @brief 给每条日志添加详细信息
+ * @brief 先判断级别是否需要输出，再根据 detailed_min 决定是否携带 spdlog::source_loc.
  * 
- * @param  msg 原始日志内容
- * @param  filename 当前文件名
- * @param  function_name 当前函数名
- * @param  line_number 当前行号
- * @return std::string 添加上述详细信息后的日志内容
+ * @details 被过滤掉的日志不做任何格式化；详细信息（文件名、函数名、行号）由各个sink的格式化器渲染，不产生额外的内存分配.
  */
-std::string suffix(const char* msg, const char* filename, const char* function_name, int line_number);
-
-inline std::string suffix(const std::string& msg, const char* filename, const char* function_name, int line_number) {
-    return suffix(msg.c_str(), filename, function_name, line_number);
-}
+#define __IC_LOG_SOURCE_LOC_(level_enum_value) \
+    (spdlog::level::level_enum::level_enum_value < ic::log::Logger::GetDetailedMin() ?\
+        spdlog::source_loc{} : spdlog::source_loc{__FILE__, __LINE__, __func__})
 
-} // namespace _internal
-} // namespace log
-} // namespace ic
-
-
-#define __IC_LOG_FMT_(level_func, level_enum_value, msg, ...) \
-    if (spdlog::level::level_enum::level_enum_value < ic::log::Logger::GetInstance().GetConfig()->detailed_min()) {\
-        ic::log::Logger::GetInstance().GetLogger()->level_func(msg, ##__VA_ARGS__);\
-    }\
-    else {\
-        ic::log::Logger::GetInstance().GetLogger()->level_func(\
-            ic::log::_internal::suffix(msg, __FILE__, __func__, __LINE__).c_str(),\
-            ##__VA_ARGS__\
-        );\
-    }
+#define __IC_LOG_FMT_(level_enum_value, msg, ...) \
+    do {\
+        spdlog::logger* __ic_log_logger = ic::log::Logger::GetRawLogger();\
+        if (__ic_log_logger->should_log(spdlog::level::level_enum::level_enum_value)) {\
+            __ic_log_logger->log(__IC_LOG_SOURCE_LOC_(level_enum_value),\
+                spdlog::level::level_enum::level_enum_value, msg, ##__VA_ARGS__);\
+        }\
+    } while (0)
 #define __IC_LOG_STRING_(level_enum_value, msg) \
-    if (spdlog::level::level_enum::level_enum_value < ic::log::Logger::GetInstance().GetConfig()->detailed_min()) {\
-        ic::log::Logger::GetInstance().GetLogger()->log(spdlog::level::level_enum::level_enum_value, msg);\
-    }\
-    else {\
-        ic::log::Logger::GetInstance().GetLogger()->log(\
-            spdlog::level::level_enum::level_enum_value,\
-            ic::log::_internal::suffix(msg, __FILE__, __func__, __LINE__)\
-        );\
-    }
+    do {\
+        spdlog::logger* __ic_log_logger = ic::log::Logger::GetRawLogger();\
+        if (__ic_log_logger->should_log(spdlog::level::level_enum::level_enum_value)) {\
+            __ic_log_logger->log(__IC_LOG_SOURCE_LOC_(level_enum_value),\
+                spdlog::level::level_enum::level_enum_value, msg);\
+        }\
+    } while (0)
 
 /**
  * @brief 宏函数重载
@@ -180,12 +280,12 @@ inline std::string suffix(const std::string& msg, const char* filename, const ch
 /**
  * @brief N个参数，(N>1).
  */
-#define _IC_LOG_LTrace_N_(msg, ...)    __IC_LOG_FMT_(trace, trace, msg, ##__VA_ARGS__)
-#define _IC_LOG_LDebug_N_(msg, ...)    __IC_LOG_FMT_(debug, debug, msg, ##__VA_ARGS__)
-#define _IC_LOG_LInfo_N_(msg, ...)     __IC_LOG_FMT_(info, info, msg, ##__VA_ARGS__)
-#define _IC_LOG_LWarn_N_(msg, ...)     __IC_LOG_FMT_(warn, warn, msg, ##__VA_ARGS__)
-#define _IC_LOG_LError_N_(msg, ...)    __IC_LOG_FMT_(error, err, msg, ##__VA_ARGS__)
-#define _IC_LOG_LCritical_N_(msg, ...) __IC_LOG_FMT_(critical, critical, msg, ##__VA_ARGS__)
+#define _IC_LOG_LTrace_N_(msg, ...)    __IC_LOG_FMT_(trace, msg, ##__VA_ARGS__)
+#define _IC_LOG_LDebug_N_(msg, ...)    __IC_LOG_FMT_(debug, msg, ##__VA_ARGS__)
+#define _IC_LOG_LInfo_N_(msg, ...)     __IC_LOG_FMT_(info, msg, ##__VA_ARGS__)
+#define _IC_LOG_LWarn_N_(msg, ...)     __IC_LOG_FMT_(warn, msg, ##__VA_ARGS__)
+#define _IC_LOG_LError_N_(msg, ...)    __IC_LOG_FMT_(err, msg, ##__VA_ARGS__)
+#define _IC_LOG_LCritical_N_(msg, ...) __IC_LOG_FMT_(critical, msg, ##__VA_ARGS__)
 
 #endif // __IC_LOG__HELPER_FUNCTION_REGION
 
@@ -15,6 +15,8 @@
 #include <map>
 #include <vector>
 #include <spdlog/spdlog.h>
+#include <spdlog/async_logger.h>
+#include <spdlog/details/thread_pool.h>
 
 namespace ic {
 namespace log {
@@ -172,6 +174,140 @@ public:
         size_t max_file_size_;
     };
 
+    /**
+     * @brief 内存映射的环形日志文件.
+     * 
+     * @details 日志直接拷贝到 mmap(MAP_SHARED) 映射的固定大小文件中，写日志不需要系统调用；
+     * @details 文件存满后从头覆盖，程序崩溃后文件中保存着最后 ring_size 字节的日志，
+     * @details 用 bin/mmap_ring_dump.out 解码(非Windows).
+     */
+    struct MmapRingFileConfig : public FileConfig {
+    public:
+        MmapRingFileConfig();
+
+        /**
+         * @brief 从键值对中读取配置.
+         */
+        bool Parse(std::map<std::string, std::string>& key_values);
+
+        /**
+         * @brief 序列化.
+         */
+        std::map<std::string, std::string> Serialize() const;
+
+        void set_ring_size(size_t size) { ring_size_ = size; }
+
+        size_t ring_size() const { return ring_size_; }
+
+    protected:
+        /** 环形缓冲区大小(文件大小另加64字节的文件头) */
+        size_t ring_size_;
+    };
+
+    /**
+     * @brief 异步日志配置.
+     * 
+     * @details 配置文件中存在 [async] 节时，使用 spdlog::async_logger，由独立的线程池写入各个sink.
+     */
+    struct AsyncConfig {
+    public:
+        AsyncConfig();
+
+        /**
+         * @brief 从键值对中读取配置.
+         */
+        bool Parse(std::map<std::string, std::string>& key_values);
+
+        /**
+         * @brief 序列化.
+         */
+        std::map<std::string, std::string> Serialize() const;
+
+        void set_queue_size(size_t size) { queue_size_ = size; }
+        void set_thread_count(size_t count) { thread_count_ = count; }
+        void set_overflow_policy(spdlog::async_overflow_policy policy) { overflow_policy_ = policy; }
+        void set_queue_type(spdlog::details::async_queue_type type) { queue_type_ = type; }
+        void set_batch_size(size_t size) { batch_size_ = size; }
+        void set_deferred_format(bool deferred) { deferred_format_ = deferred; }
+        void set_arena_size(size_t size) { arena_size_ = size; }
+        void set_wait_strategy(spdlog::details::async_wait_strategy strategy) { wait_strategy_ = strategy; }
+        void set_spin_count(size_t count) { spin_count_ = count; }
+        void set_yield_count(size_t count) { yield_count_ = count; }
+        void set_thread_name(const std::string& name) { thread_name_ = name; }
+        void set_cpu_affinity(const std::vector<int>& cpus) { cpu_affinity_ = cpus; }
+        void set_nice(int nice) { nice_ = nice; }
+        void set_sched_idle(bool sched_idle) { sched_idle_ = sched_idle; }
+        void set_sharding(spdlog::details::async_sharding sharding) { sharding_ = sharding; }
+        void set_priority_level(spdlog::level::level_enum level) { priority_level_ = level; }
+        void set_reserved_items(size_t count) { reserved_items_ = count; }
+        void set_report_drops(bool report) { report_drops_ = report; }
+        void set_telemetry(bool telemetry) { telemetry_ = telemetry; }
+
+        size_t queue_size() const { return queue_size_; }
+        size_t thread_count() const { return thread_count_; }
+        spdlog::async_overflow_policy overflow_policy() const { return overflow_policy_; }
+        spdlog::details::async_queue_type queue_type() const { return queue_type_; }
+        size_t batch_size() const { return batch_size_; }
+        bool deferred_format() const { return deferred_format_; }
+        size_t arena_size() const { return arena_size_; }
+        spdlog::details::async_wait_strategy wait_strategy() const { return wait_strategy_; }
+        size_t spin_count() const { return spin_count_; }
+        size_t yield_count() const { return yield_count_; }
+        const std::string& thread_name() const { return thread_name_; }
+        const std::vector<int>& cpu_affinity() const { return cpu_affinity_; }
+        int nice() const { return nice_; }
+        bool sched_idle() const { return sched_idle_; }
+        spdlog::details::async_sharding sharding() const { return sharding_; }
+        spdlog::level::level_enum priority_level() const { return priority_level_; }
+        size_t reserved_items() const { return reserved_items_; }
+        bool report_drops() const { return report_drops_; }
+        bool telemetry() const { return telemetry_; }
+
+    protected:
+        /** 队列容量(消息条数) */
+        size_t queue_size_;
+        /** 后台线程数量 */
+        size_t thread_count_;
+        /** 队列已满时的处理策略(block: 阻塞等待, overrun_oldest: 覆盖最旧的消息, discard_new: 丢弃新消息，从不阻塞,
+            drop_below_level: 丢弃低于 priority_level 的新消息，其余阻塞等待) */
+        spdlog::async_overflow_policy overflow_policy_;
+        /** 队列类型(blocking: 互斥锁+条件变量, lockfree: 无锁队列，仅在后台线程休眠时唤醒,
+            per_thread: 每个线程独立的无锁环形队列，后台线程按时间合并，thread_count 必须为1) */
+        spdlog::details::async_queue_type queue_type_;
+        /** 后台线程每次最多取出的消息条数，同一批消息合并写入sink */
+        size_t batch_size_;
+        /** 是否在后台线程格式化日志(调用线程只拷贝格式字符串和参数) */
+        bool deferred_format_;
+        /** 预分配的日志内容缓冲区大小(字节)，0表示按 queue_size * 128 分配 */
+        size_t arena_size_;
+        /** 后台线程空闲时的等待策略(blocking: 休眠等待唤醒, spin: 自旋(pause指令), spin_yield_park: 先自旋再让出CPU最后休眠,
+            busy_poll: 不停轮询，适合独占CPU核心的后台线程) */
+        spdlog::details::async_wait_strategy wait_strategy_;
+        /** spin_yield_park: 自旋次数 */
+        size_t spin_count_;
+        /** spin_yield_park: 自旋之后让出CPU(yield)的次数，之后休眠 */
+        size_t yield_count_;
+        /** 后台线程名称前缀，线程名为 "前缀-序号"，如 ic-log-0 (为空时不设置) */
+        std::string thread_name_;
+        /** 后台线程绑定的CPU (为空时不绑定，仅Linux) */
+        std::vector<int> cpu_affinity_;
+        /** 后台线程的nice值 (0表示不修改，仅Linux) */
+        int nice_;
+        /** 后台线程是否使用SCHED_IDLE调度策略 (仅Linux) */
+        bool sched_idle_;
+        /** 消息分配到后台线程的方式(none: 所有线程共享一个队列, logger: 每个logger固定由一个线程处理,
+            sink: 每个sink固定由一个线程处理，慢的sink(如文件)不会拖慢快的sink(如控制台)，同一sink的日志保持顺序) */
+        spdlog::details::async_sharding sharding_;
+        /** drop_below_level: 不低于此级别的日志总是入队(队列满时阻塞等待) */
+        spdlog::level::level_enum priority_level_;
+        /** discard_new、drop_below_level: 队列中为 err、critical 日志保留的容量(消息条数)，低级别的日志不能占用 */
+        size_t reserved_items_;
+        /** 有日志因队列满被丢弃时，是否由后台线程输出一条警告，如 "dropped 1834 messages (overrun) since 12:00:01.123" */
+        bool report_drops_;
+        /** 是否统计出队条数、队列最大深度和日志从调用到写入sink的延迟(见 Logger::GetStats()) */
+        bool telemetry_;
+    };
+
 public:
     LoggerConfig();
 
@@ -209,19 +345,29 @@ public:
     DetailedFilenameType detailed_filename_type() const { return detailed_filename_type_; }
     spdlog::level::level_enum flush_on() const { return flush_on_; }
     size_t flush_every() const { return flush_every_; }
+    size_t stats_every() const { return stats_every_; }
+    bool crash_handler() const { return crash_handler_; }
     const std::string& name() const { return name_; }
     const std::vector<ConsoleConfig>& console_configs() const { return console_configs_; }
     const std::vector<DailyFileConfig>& daily_file_configs() const { return daily_file_configs_; }
     const std::vector<RotatingFileConfig>& rotating_file_configs() const { return rotating_file_configs_; }
+    const std::vector<MmapRingFileConfig>& mmap_ring_file_configs() const { return mmap_ring_file_configs_; }
+    bool async() const { return async_; }
+    const AsyncConfig& async_config() const { return async_config_; }
 
     void set_detailed_min(spdlog::level::level_enum detailed_min) { detailed_min_ = detailed_min; }
     void set_detailed_filename_type(DetailedFilenameType type) { detailed_filename_type_ = type; }
     void set_flush_on(spdlog::level::level_enum flush_on) { flush_on_ = flush_on; }
     void set_flush_every(size_t flush_every) { flush_every_ = flush_every; }
+    void set_stats_every(size_t stats_every) { stats_every_ = stats_every; }
+    void set_crash_handler(bool crash_handler) { crash_handler_ = crash_handler; }
     void set_name(const std::string& name);
     void add_console_config(const ConsoleConfig& config) { console_configs_.push_back(config); }
     void add_daily_file_config(const DailyFileConfig& config) { daily_file_configs_.push_back(config); }
     void add_rotating_file_config(const RotatingFileConfig& config) { rotating_file_configs_.push_back(config); }
+    void add_mmap_ring_file_config(const MmapRingFileConfig& config) { mmap_ring_file_configs_.push_back(config); }
+    void set_async_config(const AsyncConfig& config) { async_config_ = config; async_ = true; }
+    void clear_async_config() { async_config_ = AsyncConfig(); async_ = false; }
 
 private:
     bool ParseBasic(std::map<std::string, std::string>& key_values);
@@ -244,6 +390,10 @@ private:
     spdlog::level::level_enum flush_on_;
     /** 每隔多长时间刷新，单位：秒 */
     size_t flush_every_;
+    /** 每隔多长时间输出一次统计信息(info级别)，单位：秒，0表示不输出 */
+    size_t stats_every_;
+    /** 程序崩溃(SIGSEGV, SIGABRT, SIGBUS, SIGFPE)时写出缓冲区和异步队列中尚未写入的日志(非Windows) */
+    bool crash_handler_;
     /** 日志记录器名称 */
     std::string name_;
 
@@ -253,6 +403,13 @@ private:
     std::vector<DailyFileConfig> daily_file_configs_;
     /** 所有的滚动日志配置信息 */
     std::vector<RotatingFileConfig> rotating_file_configs_;
+    /** 所有的内存映射环形日志配置信息 */
+    std::vector<MmapRingFileConfig> mmap_ring_file_configs_;
+
+    /** 是否异步输出 */
+    bool async_;
+    /** 异步日志配置信息 */
+    AsyncConfig async_config_;
 };
 
 } // namespace log
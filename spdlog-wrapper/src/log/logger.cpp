@@ -2,29 +2,393 @@
 #include "log/logger_config.h"
 #include "log/simple_console_logger.h"
 #include <spdlog/common.h>
+#include <spdlog/async_logger.h>
+#include <spdlog/details/thread_pool.h>
+#include <spdlog/pattern_formatter.h>
+#include <spdlog/static_pattern_formatter.h>
 #include <spdlog/sinks/daily_file_sink.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_sinks.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
+#include <cctype>
+#ifndef _WIN32
+    #include <csignal>
+    #include <cstring>
+    #include <signal.h>
+    #include <spdlog/sinks/mmap_ring_sink.h>
+#endif
 
 namespace ic {
 namespace log {
 
 std::shared_ptr<LoggerConfig> Logger::s_config;
+std::atomic<spdlog::logger*> Logger::s_raw_logger{nullptr};
+std::atomic<spdlog::level::level_enum> Logger::s_detailed_min{spdlog::level::err};
+
+namespace _internal {
+
+/**
+ * @brief 详细信息格式化标记(%*)，输出 ` <文件名> <函数名> <行号>`.
+ * 
+ * @details 只有携带 source_loc 的日志（即级别不低于 detailed_min）才会输出，
+ *          文件名类型(%g 或 %s)在创建时确定，格式化过程中不分配内存.
+ */
+class detailed_flag_formatter : public spdlog::custom_flag_formatter {
+public:
+    explicit detailed_flag_formatter(LoggerConfig::DetailedFilenameType filename_type)
+        : filename_type_(filename_type),
+          formatter_(filename_type == LoggerConfig::DetailedFilenameType::FullPath ?
+                     " <%g> <%!> <%#>" : " <%s> <%!> <%#>",
+                     spdlog::pattern_time_type::local, "")
+    {
+    }
+
+    void format(const spdlog::details::log_msg& msg, const std::tm&, spdlog::memory_buf_t& dest) override {
+        if (!msg.source.empty()) {
+            formatter_.format(msg, dest);
+        }
+    }
+
+    std::unique_ptr<spdlog::custom_flag_formatter> clone() const override {
+        return spdlog::details::make_unique<detailed_flag_formatter>(filename_type_);
+    }
+
+    /** 输出只取决于文件名类型，相同 pattern 的sink可以共用格式化结果 */
+    std::string identity() const override {
+        return filename_type_ == LoggerConfig::DetailedFilenameType::FullPath ? "detailed:full_path" : "detailed:name_only";
+    }
+
+private:
+    LoggerConfig::DetailedFilenameType filename_type_;
+    spdlog::pattern_formatter formatter_;
+};
+
+/**
+ * @brief 编译期格式化器(spdlog::static_pattern_formatter)中的详细信息标记(%*).
+ */
+struct detailed_token {
+    static const bool needs_tm = false;
+
+    detailed_token() : flag_(Logger::GetConfig()->detailed_filename_type()) {}
+
+    void format(const spdlog::details::log_msg& msg, const std::tm& tm_time, spdlog::memory_buf_t& dest) {
+        flag_.format(msg, tm_time, dest);
+    }
+
+    static void append_pattern(std::string& pattern) { pattern += "%*"; }
+
+    /** 与 %* 自定义标记相同，使编译期格式化器与同 pattern 的 spdlog::pattern_formatter 共用格式化结果 */
+    std::string identity() const { return flag_.identity(); }
+
+    detailed_flag_formatter flag_;
+};
+
+namespace static_formatters {
+
+using namespace spdlog::static_pattern;
+
+/** [%H:%M:%S.%e] */
+using time_hms = timestamp<text<'['>, hour, text<':'>, minute, text<':'>, second, text<'.'>, millis, text<']', ' '>>;
+/** [%Y-%m-%d %H:%M:%S.%e] */
+using time_ymd_hms = timestamp<text<'['>, year, text<'-'>, month, text<'-'>, day, text<' '>,
+                               hour, text<':'>, minute, text<':'>, second, text<'.'>, millis, text<']', ' '>>;
+
+/** [%H:%M:%S.%e] [%l] %v%* */
+using hms = spdlog::static_pattern_formatter<time_hms, text<'['>, level, text<']', ' '>, payload, detailed_token>;
+/** [%H:%M:%S.%e] %^[%l]%$ %v%* */
+using hms_color = spdlog::static_pattern_formatter<time_hms, color_start, text<'['>, level, text<']'>, color_stop,
+                                                   text<' '>, payload, detailed_token>;
+/** [%Y-%m-%d %H:%M:%S.%e] [%l] %v%* */
+using ymd_hms = spdlog::static_pattern_formatter<time_ymd_hms, text<'['>, level, text<']', ' '>, payload, detailed_token>;
+
+template<typename Formatter>
+static bool match(const std::string& pattern, std::unique_ptr<spdlog::formatter>& formatter) {
+    if (pattern != Formatter::pattern()) {
+        return false;
+    }
+    formatter = spdlog::details::make_unique<Formatter>();
+    return true;
+}
+
+} // namespace static_formatters
+
+/**
+ * @brief 配置的 pattern 是常用格式(默认格式及示例配置中的格式)之一时，返回编译期展开的格式化器，否则返回nullptr.
+ * 
+ * @details 输出与 spdlog::pattern_formatter 完全相同，省去逐个标记的解释执行.
+ */
+static std::unique_ptr<spdlog::formatter> make_static_formatter(const std::string& pattern) {
+    std::unique_ptr<spdlog::formatter> formatter;
+    static_formatters::match<static_formatters::hms>(pattern, formatter) ||
+        static_formatters::match<static_formatters::hms_color>(pattern, formatter) ||
+        static_formatters::match<static_formatters::ymd_hms>(pattern, formatter);
+    return formatter;
+}
+
+/**
+ * @brief 查找 pattern 中第一个 %v 标记(可带对齐/截断，如 %-20v、%20!v)，返回其后的位置，没有则返回 npos.
+ * 
+ * @details 与 spdlog::pattern_formatter 的解析方式一致：%% 是字面的 %，对齐为 [-=]?数字[!]?.
+ */
+static size_t find_payload_flag_end(const std::string& pattern) {
+    size_t i = 0;
+    while ((i = pattern.find('%', i)) != std::string::npos) {
+        ++i;
+        if (i < pattern.size() && (pattern[i] == '-' || pattern[i] == '=')) {
+            ++i;
+        }
+        if (i < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[i]))) {
+            while (i < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[i]))) {
+                ++i;
+            }
+            if (i < pattern.size() && pattern[i] == '!') {
+                ++i;
+            }
+        }
+        if (i >= pattern.size()) {
+            break;
+        }
+        if (pattern[i] == 'v') {
+            return i + 1;
+        }
+        /* 标记字符(包括 %% 的第二个 %)不再作为新标记的开始 */
+        ++i;
+    }
+    return std::string::npos;
+}
+
+/**
+ * @brief 创建sink使用的格式化器，在 %v 之后(没有 %v 则在末尾)插入详细信息标记.
+ */
+static std::unique_ptr<spdlog::formatter> make_formatter(std::string pattern) {
+    auto pos = find_payload_flag_end(pattern);
+    if (pos == std::string::npos) {
+        pattern += "%*";
+    }
+    else {
+        pattern.insert(pos, "%*");
+    }
+    auto static_formatter = make_static_formatter(pattern);
+    if (static_formatter) {
+        return static_formatter;
+    }
+    auto formatter = spdlog::details::make_unique<spdlog::pattern_formatter>();
+    formatter->add_flag<detailed_flag_formatter>('*', Logger::GetConfig()->detailed_filename_type());
+    formatter->set_pattern(std::move(pattern));
+    return formatter;
+}
+
+#ifndef _WIN32
+/**
+ * @brief 崩溃处理(crash_handler = true)：致命信号到来时写出尚未写入的日志，然后交还给原来的信号处理方式.
+ * 
+ * @details 信号处理函数中只使用异步信号安全的操作(不加锁、不分配内存，只调用 write(2) 等)：
+ * @details (1) 停止后台线程，等待(最多100毫秒)正在写入的那一批日志写完；
+ * @details (2) 各个sink的 FILE 缓冲区中的内容直接写入文件描述符(仅glibc)；
+ * @details (3) 异步队列中的日志以固定格式写入级别匹配的sink；
+ * @details (4) 恢复原来的信号处理方式，重新发出该信号.
+ */
+static const int s_crash_signals[] = { SIGSEGV, SIGABRT, SIGBUS, SIGFPE };
+static const size_t s_crash_signals_count = sizeof(s_crash_signals) / sizeof(s_crash_signals[0]);
+
+struct crash_state {
+    std::vector<spdlog::sink_ptr> sinks;
+    spdlog::details::thread_pool* pool = nullptr;
+    /* 安装时的UTC偏移(秒)，信号处理函数中不能调用 localtime_r */
+    long utc_offset = 0;
+    size_t recovered = 0;
+    struct sigaction old_actions[s_crash_signals_count];
+};
+
+static std::atomic<crash_state*> s_crash_state{nullptr};
+
+static char* put_digits(char* p, unsigned long value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        p[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    return p + width;
+}
+
+static char* put_number(char* p, unsigned long value) {
+    int width = 1;
+    for (unsigned long tmp = value; tmp >= 10; tmp /= 10) {
+        ++width;
+    }
+    return put_digits(p, value, width);
+}
+
+/**
+ * @brief 1970-01-01 起的天数转换为年月日(不调用 gmtime_r 等非异步信号安全的函数).
+ */
+static void civil_from_days(long days, long& year, unsigned& month, unsigned& day) {
+    days += 719468;
+    long era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned doe = static_cast<unsigned>(days - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<long>(yoe) + era * 400 + (month <= 2 ? 1 : 0);
+}
+
+/**
+ * @brief 以 `[yyyy-mm-dd HH:MM:SS.mmm] [level] 内容` 的格式写入级别匹配的sink.
+ */
+static void crash_write(const spdlog::details::log_msg& msg, crash_state* state) {
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(msg.time.time_since_epoch()).count();
+    long seconds = static_cast<long>(ms / 1000) + state->utc_offset;
+    long days = seconds >= 0 ? seconds / 86400 : (seconds - 86399) / 86400;
+    long second_of_day = seconds - days * 86400;
+    long year;
+    unsigned month, day;
+    civil_from_days(days, year, month, day);
+
+    char prefix[64];
+    char* p = prefix;
+    *p++ = '[';
+    p = put_digits(p, static_cast<unsigned long>(year), 4);
+    *p++ = '-';
+    p = put_digits(p, month, 2);
+    *p++ = '-';
+    p = put_digits(p, day, 2);
+    *p++ = ' ';
+    p = put_digits(p, static_cast<unsigned long>(second_of_day / 3600), 2);
+    *p++ = ':';
+    p = put_digits(p, static_cast<unsigned long>(second_of_day % 3600 / 60), 2);
+    *p++ = ':';
+    p = put_digits(p, static_cast<unsigned long>(second_of_day % 60), 2);
+    *p++ = '.';
+    p = put_digits(p, static_cast<unsigned long>(ms % 1000), 3);
+    *p++ = ']';
+    *p++ = ' ';
+    *p++ = '[';
+    auto level_name = spdlog::level::to_string_view(msg.level);
+    for (size_t i = 0; i < level_name.size() && i < 16; ++i) {
+        *p++ = level_name.data()[i];
+    }
+    *p++ = ']';
+    *p++ = ' ';
+
+    for (auto& sink : state->sinks) {
+        std::FILE* stream = sink->stream_unsafe();
+        if (stream == nullptr || !sink->should_log(msg.level)) {
+            continue;
+        }
+        int fd = spdlog::details::os::fileno_unsafe(stream);
+        spdlog::details::os::write_fd(fd, prefix, static_cast<size_t>(p - prefix));
+        spdlog::details::os::write_fd(fd, msg.payload.data(), msg.payload.size());
+        spdlog::details::os::write_fd(fd, "\n", 1);
+    }
+}
+
+static void crash_write_queued(const spdlog::details::log_msg& msg, void* ctx) {
+    auto state = static_cast<crash_state*>(ctx);
+    crash_write(msg, state);
+    ++state->recovered;
+}
+
+static void on_fatal_signal(int sig) {
+    static volatile std::sig_atomic_t s_handling = 0;
+    crash_state* state = s_crash_state.load(std::memory_order_acquire);
+    if (state != nullptr && !s_handling) {
+        s_handling = 1;
+        /* 工作线程未能在超时前停下时，不能安全地遍历队列 */
+        bool frozen = state->pool && state->pool->freeze_unsafe(std::chrono::milliseconds(100));
+        /* 先写出 FILE 缓冲区(较早的日志)，再写出队列中的日志 */
+        for (auto& sink : state->sinks) {
+            std::FILE* stream = sink->stream_unsafe();
+            if (stream != nullptr) {
+                spdlog::details::os::flush_stdio_unsafe(stream);
+            }
+        }
+        if (frozen) {
+            state->pool->visit_queued_unsafe(crash_write_queued, state);
+        }
+        else if (state->pool) {
+            spdlog::string_view_t text("crash: async workers still busy, queue not dumped");
+            spdlog::details::log_msg msg(spdlog::log_clock::now(), spdlog::source_loc{}, spdlog::string_view_t(),
+                spdlog::level::critical, text);
+            crash_write(msg, state);
+        }
+
+        char text[96] = "crash: caught signal ";
+        char* p = text + sizeof("crash: caught signal ") - 1;
+        p = put_number(p, static_cast<unsigned long>(sig));
+        const char recovered[] = ", queued messages recovered: ";
+        for (size_t i = 0; i + 1 < sizeof(recovered); ++i) {
+            *p++ = recovered[i];
+        }
+        p = put_number(p, static_cast<unsigned long>(state->recovered));
+        spdlog::details::log_msg msg(spdlog::log_clock::now(), spdlog::source_loc{}, spdlog::string_view_t(),
+            spdlog::level::critical, spdlog::string_view_t(text, static_cast<size_t>(p - text)));
+        crash_write(msg, state);
+
+        for (size_t i = 0; i < s_crash_signals_count; ++i) {
+            if (s_crash_signals[i] == sig) {
+                sigaction(sig, &state->old_actions[i], nullptr);
+            }
+        }
+    }
+    else {
+        signal(sig, SIG_DFL);
+    }
+    /* 返回后(信号解除阻塞)按原来的方式处理 */
+    raise(sig);
+}
+
+static void install_crash_handler(const std::vector<spdlog::sink_ptr>& sinks, spdlog::details::thread_pool* pool) {
+    auto state = new crash_state();
+    state->sinks = sinks;
+    state->pool = pool;
+    state->utc_offset = static_cast<long>(spdlog::details::os::utc_minutes_offset()) * 60;
+    s_crash_state.store(state, std::memory_order_release);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_fatal_signal;
+    sigemptyset(&action.sa_mask);
+    for (size_t i = 0; i < s_crash_signals_count; ++i) {
+        sigaction(s_crash_signals[i], &action, &state->old_actions[i]);
+    }
+}
+
+static void uninstall_crash_handler() {
+    crash_state* state = s_crash_state.load(std::memory_order_acquire);
+    if (state == nullptr) {
+        return;
+    }
+    for (size_t i = 0; i < s_crash_signals_count; ++i) {
+        /* 之后被其他代码替换的处理方式保持不变 */
+        struct sigaction current;
+        if (sigaction(s_crash_signals[i], nullptr, &current) == 0 && current.sa_handler == on_fatal_signal) {
+            sigaction(s_crash_signals[i], &state->old_actions[i], nullptr);
+        }
+    }
+    s_crash_state.store(nullptr, std::memory_order_release);
+    delete state;
+}
+#endif
+
+} // namespace _internal
 
 void Logger::SetConfig(const LoggerConfig& config) {
     s_config = std::make_shared<LoggerConfig>(config);
+    s_detailed_min.store(s_config->detailed_min(), std::memory_order_relaxed);
 }
 
 void Logger::SetConfig(std::shared_ptr<LoggerConfig> config) {
     s_config = config;
+    s_detailed_min.store(s_config->detailed_min(), std::memory_order_relaxed);
 }
 
 Logger::Logger() {
     /* 至少有1个sink */
     if (s_config->console_configs().empty() &&
         s_config->daily_file_configs().empty() &&
-        s_config->rotating_file_configs().empty())
+        s_config->rotating_file_configs().empty() &&
+        s_config->mmap_ring_file_configs().empty())
     {
         s_config->add_console_config({});
     }
@@ -41,15 +405,16 @@ Logger::Logger() {
             auto sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
             sink->set_color_mode(spdlog::color_mode::always);
             sink->set_level(config.level());
-            sink->set_pattern(config.pattern());
+            sink->set_formatter(_internal::make_formatter(config.pattern()));
             sinks.push_back(sink);
         }
         else {
             auto sink = std::make_shared<spdlog::sinks::stdout_sink_mt>();
             sink->set_level(config.level());
-            sink->set_pattern(config.pattern());
+            sink->set_formatter(_internal::make_formatter(config.pattern()));
             sinks.push_back(sink);
         }
+        sink_names.push_back("console");
     }
     /* 每日日志 */
     for (auto& config : s_config->daily_file_configs()) {
@@ -59,8 +424,9 @@ Logger::Logger() {
         /* 每天0点0分，创建新的日志文件 */
         auto sink = std::make_shared<spdlog::sinks::daily_file_sink_mt>(config.GetFilename(), 0, 0);
         sink->set_level(config.level());
-        sink->set_pattern(config.pattern());
+        sink->set_formatter(_internal::make_formatter(config.pattern()));
         sinks.push_back(sink);
+        sink_names.push_back("daily:" + config.GetFilename());
     }
     /* 滚动日志 */
     for (auto& config : s_config->rotating_file_configs()) {
@@ -70,46 +436,163 @@ Logger::Logger() {
         auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
             config.GetFilename(), config.max_file_size(), config.max_files_count());
         sink->set_level(config.level());
-        sink->set_pattern(config.pattern());
+        sink->set_formatter(_internal::make_formatter(config.pattern()));
         sinks.push_back(sink);
+        sink_names.push_back("rotating:" + config.GetFilename());
+    }
+    /* 内存映射的环形日志 */
+    for (auto& config : s_config->mmap_ring_file_configs()) {
+#ifndef _WIN32
+        if (config.level() < min_level) {
+            min_level = config.level();
+        }
+        auto sink = std::make_shared<spdlog::sinks::mmap_ring_sink_mt>(config.GetFilename(), config.ring_size());
+        sink->set_level(config.level());
+        sink->set_formatter(_internal::make_formatter(config.pattern()));
+        sinks.push_back(sink);
+        sink_names.push_back("mmap_ring:" + config.GetFilename());
+#else
+        Log("Warning: mmap_ring is not supported on Windows, ignore '{}'", config.GetFilename());
+#endif
     }
 
-    logger = std::make_shared<spdlog::logger>(s_config->name(), std::begin(sinks), std::end(sinks));
+    /* 编译期级别(IC_LOG_ACTIVE_LEVEL)以下的日志不会被输出 */
+    if (min_level < static_cast<spdlog::level::level_enum>(IC_LOG_ACTIVE_LEVEL)) {
+        min_level = static_cast<spdlog::level::level_enum>(IC_LOG_ACTIVE_LEVEL);
+    }
+
+    if (s_config->async()) {
+        /* 异步：由独立线程池写入各个sink，调用线程只负责入队 */
+        auto& async_config = s_config->async_config();
+        spdlog::details::thread_pool_options options;
+        options.queue_type = async_config.queue_type();
+        options.batch_size = async_config.batch_size();
+        options.arena_size = async_config.arena_size();
+        options.wait_strategy = async_config.wait_strategy();
+        options.spin_count = async_config.spin_count();
+        options.yield_count = async_config.yield_count();
+        options.thread_name = async_config.thread_name();
+        options.cpu_affinity = async_config.cpu_affinity();
+        options.nice = async_config.nice();
+        options.sched_idle = async_config.sched_idle();
+        options.sharding = async_config.sharding();
+        options.priority_level = async_config.priority_level();
+        options.reserved_items = async_config.reserved_items();
+        options.report_drops = async_config.report_drops();
+        options.telemetry = async_config.telemetry() || s_config->stats_every() > 0;
+        thread_pool = std::make_shared<spdlog::details::thread_pool>(
+            async_config.queue_size(), async_config.thread_count(), options);
+        auto async_logger = std::make_shared<spdlog::async_logger>(s_config->name(), std::begin(sinks), std::end(sinks),
+            thread_pool, async_config.overflow_policy());
+        async_logger->set_deferred_formatting(async_config.deferred_format());
+        logger = async_logger;
+    }
+    else {
+        logger = std::make_shared<spdlog::logger>(s_config->name(), std::begin(sinks), std::end(sinks));
+    }
     logger->set_level(min_level);
     logger->flush_on(s_config->flush_on());
     spdlog::register_logger(logger);
+    s_detailed_min.store(s_config->detailed_min(), std::memory_order_relaxed);
+    s_raw_logger.store(logger.get(), std::memory_order_release);
     spdlog::flush_every(std::chrono::seconds(s_config->flush_every()));
+    if (s_config->stats_every() > 0) {
+        stats_worker = spdlog::details::make_unique<spdlog::details::periodic_worker>([this] {
+            logger->info("[stats] {}", GetStats().ToString());
+        }, std::chrono::seconds(s_config->stats_every()));
+    }
+#ifndef _WIN32
+    if (s_config->crash_handler()) {
+        _internal::install_crash_handler(logger->sinks(), thread_pool.get());
+    }
+#endif
     SPDLOG_LOGGER_DEBUG(logger, "SpdDebug");
 }
 
 Logger::~Logger() {
+#ifndef _WIN32
+    _internal::uninstall_crash_handler();
+#endif
+    stats_worker.reset();
+    s_raw_logger.store(nullptr, std::memory_order_release);
     spdlog::drop_all();
 }
 
-namespace _internal {
-
-std::string suffix(const char* msg, const char* filename, const char* function_name, int line_number) {
-    auto config = ic::log::Logger::GetConfig();
-    std::string result;
-    result.reserve(128);
-    result += msg;
-    result += " <";
-    result += (config->detailed_filename_type() == LoggerConfig::DetailedFilenameType::FullPath) ?
-              filename :
-#ifdef _WIN32
-              (strrchr(filename, '\\') ? (strrchr(filename, '\\') + 1) : filename);
-#else
-              (strrchr(filename, '/') ? (strrchr(filename, '/') + 1) : filename);
-#endif
-    result += "> <";
-    result += function_name;
-    result += "> <";
-    result += std::to_string(line_number);
-    result += ">";
+LoggerStats Logger::GetStats() const {
+    LoggerStats result;
+    if (thread_pool) {
+        result.async = true;
+        result.queue = thread_pool->stats();
+    }
+    auto& sinks = logger->sinks();
+    for (size_t i = 0; i < sinks.size(); ++i) {
+        LoggerStats::SinkStats sink_stats;
+        sink_stats.name = i < sink_names.size() ? sink_names[i] : "sink" + std::to_string(i);
+        sink_stats.stats = sinks[i]->stats();
+        result.sinks.push_back(std::move(sink_stats));
+    }
     return result;
 }
 
-} // namespace _internal
+size_t Logger::Shutdown(std::chrono::milliseconds timeout) {
+    if (shut_down.exchange(true)) {
+        return shutdown_lost;
+    }
+    stats_worker.reset();
+
+    if (thread_pool) {
+        /* 停止接收、限时写完队列，之后后台线程已退出，可以直接操作sink */
+        thread_pool->shutdown(timeout);
+        shutdown_lost = thread_pool->dropped_counter();
+    }
+    else {
+        logger->set_level(spdlog::level::off);
+    }
+
+    auto& sinks = logger->sinks();
+    if (shutdown_lost > 0) {
+        spdlog::memory_buf_t buf;
+        fmt::format_to(std::back_inserter(buf), "shutdown: {} messages lost", shutdown_lost);
+        spdlog::details::log_msg msg(logger->name(), spdlog::level::warn, spdlog::string_view_t(buf.data(), buf.size()));
+        for (auto& sink : sinks) {
+            if (sink->should_log(msg.level)) {
+                sink->log(msg);
+            }
+        }
+    }
+    for (size_t i = 0; i < sinks.size(); ++i) {
+        try {
+            sinks[i]->sync();
+        }
+        catch (const std::exception& ex) {
+            Log("Error: failed to sync {}: {}", i < sink_names.size() ? sink_names[i] : "sink" + std::to_string(i), ex.what());
+        }
+    }
+    return shutdown_lost;
+}
+
+std::string LoggerStats::ToString() const {
+    spdlog::memory_buf_t buf;
+    if (async) {
+        fmt::format_to(std::back_inserter(buf),
+            "queue: depth={} high_water={} enqueued={} dequeued={} overrun={} dropped={} "
+            "latency_us: p50={} p90={} p99={} p999={} max={}",
+            queue.queue_depth, queue.queue_high_water, queue.enqueued, queue.dequeued, queue.overrun, queue.dropped,
+            queue.latency.p50_ns / 1000, queue.latency.p90_ns / 1000, queue.latency.p99_ns / 1000,
+            queue.latency.p999_ns / 1000, queue.latency.max_ns / 1000);
+    }
+    for (auto& sink : sinks) {
+        if (buf.size() > 0) {
+            buf.push_back(' ');
+            buf.push_back('|');
+            buf.push_back(' ');
+        }
+        fmt::format_to(std::back_inserter(buf), "{}: bytes={} writes={} flushes={} flush_us: total={} max={}",
+            sink.name, sink.stats.bytes_written, sink.stats.writes, sink.stats.flushes,
+            sink.stats.flush_time_total_ns / 1000, sink.stats.flush_time_max_ns / 1000);
+    }
+    return std::string(buf.data(), buf.size());
+}
 
 } // namespace log
 } // namespace ic
@@ -12,11 +12,32 @@ namespace log {
 #define CFG_DEFAULT_DIRECTORY       "${bin}/logs/"
 #define CFG_DEFAULT_NAME            "log"
 #define CFG_DEFAULT_FLUSH_EVERY     1
+#define CFG_DEFAULT_STATS_EVERY     0
+#define CFG_DEFAULT_CRASH_HANDLER   false
 #define CFG_DEFAULT_MAX_FILES_COUNT 10
 #define CFG_DEFAULT_MAX_FILE_SIZE   1024 * 1024 * 5 /* 5MB */
+#define CFG_DEFAULT_RING_SIZE       1024 * 1024 * 4 /* 4MB */
 #define CFG_DEFAULT_PATTERN         "[%H:%M:%S.%e] [%l] %v"
 #define CFG_DEFAULT_PATTERN_WITH_COLOR     "[%H:%M:%S.%e] %^[%l]%$ %v"
 #define CFG_DEFAULT_DETAILED_FILENAME_TYPE DetailedFilenameType::NameOnly
+#define CFG_DEFAULT_QUEUE_SIZE      8192
+#define CFG_DEFAULT_THREAD_COUNT    1
+#define CFG_DEFAULT_OVERFLOW_POLICY spdlog::async_overflow_policy::block
+#define CFG_DEFAULT_QUEUE_TYPE      spdlog::details::async_queue_type::blocking
+#define CFG_DEFAULT_BATCH_SIZE      64
+#define CFG_DEFAULT_DEFERRED_FORMAT false
+#define CFG_DEFAULT_ARENA_SIZE      0
+#define CFG_DEFAULT_WAIT_STRATEGY   spdlog::details::async_wait_strategy::blocking
+#define CFG_DEFAULT_SPIN_COUNT      4096
+#define CFG_DEFAULT_YIELD_COUNT     64
+#define CFG_DEFAULT_THREAD_NAME     "ic-log"
+#define CFG_DEFAULT_NICE            0
+#define CFG_DEFAULT_SCHED_IDLE      false
+#define CFG_DEFAULT_SHARDING        spdlog::details::async_sharding::none
+#define CFG_DEFAULT_PRIORITY_LEVEL  spdlog::level::warn
+#define CFG_DEFAULT_RESERVED_ITEMS  0
+#define CFG_DEFAULT_REPORT_DROPS    true
+#define CFG_DEFAULT_TELEMETRY       false
 
 LoggerConfig::ConsoleConfig::ConsoleConfig()
     : level_(CFG_DEFAULT_LEVEL), pattern_(CFG_DEFAULT_PATTERN_WITH_COLOR)
@@ -55,6 +76,26 @@ LoggerConfig::RotatingFileConfig::RotatingFileConfig()
     set_name("log");
 }
 
+LoggerConfig::MmapRingFileConfig::MmapRingFileConfig()
+    : ring_size_(CFG_DEFAULT_RING_SIZE)
+{
+    set_name("ring");
+    set_ext(".bin");
+}
+
+LoggerConfig::AsyncConfig::AsyncConfig()
+    : queue_size_(CFG_DEFAULT_QUEUE_SIZE), thread_count_(CFG_DEFAULT_THREAD_COUNT),
+      overflow_policy_(CFG_DEFAULT_OVERFLOW_POLICY), queue_type_(CFG_DEFAULT_QUEUE_TYPE),
+      batch_size_(CFG_DEFAULT_BATCH_SIZE), deferred_format_(CFG_DEFAULT_DEFERRED_FORMAT),
+      arena_size_(CFG_DEFAULT_ARENA_SIZE), wait_strategy_(CFG_DEFAULT_WAIT_STRATEGY),
+      spin_count_(CFG_DEFAULT_SPIN_COUNT), yield_count_(CFG_DEFAULT_YIELD_COUNT),
+      thread_name_(CFG_DEFAULT_THREAD_NAME), nice_(CFG_DEFAULT_NICE), sched_idle_(CFG_DEFAULT_SCHED_IDLE),
+      sharding_(CFG_DEFAULT_SHARDING), priority_level_(CFG_DEFAULT_PRIORITY_LEVEL),
+      reserved_items_(CFG_DEFAULT_RESERVED_ITEMS), report_drops_(CFG_DEFAULT_REPORT_DROPS),
+      telemetry_(CFG_DEFAULT_TELEMETRY)
+{
+}
+
 void LoggerConfig::FileConfig::set_directory(const std::string& directory) {
     directory_ = directory;
     log::util::trim(directory_);
@@ -195,6 +236,16 @@ std::string LoggerConfig::FileConfig::GetFilename() const {
         max_file_size_ = static_cast<size_t>(tmp);\
     }
 
+#define GET_RING_SIZE() \
+    {\
+        uint64_t tmp;\
+        if (!util::parse_filesize(key_values["ring_size"], tmp) || tmp == 0) {\
+            Log("Error: Value of key 'ring_size' is invalid");\
+            return false;\
+        }\
+        ring_size_ = static_cast<size_t>(tmp);\
+    }
+
 #define GET_FLUSH_EVERY() \
     {\
         auto tmp = key_values["flush_every"];\
@@ -207,6 +258,39 @@ std::string LoggerConfig::FileConfig::GetFilename() const {
         flush_every_ = std::stoul(tmp);\
     }
 
+/* 可选 */
+#define GET_STATS_EVERY() \
+    if (key_values.find("stats_every") != key_values.end()) {\
+        auto tmp = key_values["stats_every"];\
+        if (tmp.empty()) {\
+            Log("Error: Value of key 'stats_every' is invalid");\
+            return false;\
+        }\
+        for (auto c : tmp) {\
+            if (c < '0' || c > '9') {\
+                Log("Error: Value of key 'stats_every' is invalid");\
+                return false;\
+            }\
+        }\
+        stats_every_ = std::stoul(tmp);\
+    }
+
+/* 可选 */
+#define GET_CRASH_HANDLER() \
+    if (key_values.find("crash_handler") != key_values.end()) {\
+        auto tmp = key_values["crash_handler"];\
+        if (tmp == "true") {\
+            crash_handler_ = true;\
+        }\
+        else if (tmp == "false") {\
+            crash_handler_ = false;\
+        }\
+        else {\
+            Log("Error: Value of key 'crash_handler' is invalid. (Acceptable: true, false)");\
+            return false;\
+        }\
+    }
+
 #define GET_FLUSH_ON() \
     {\
         auto tmp = spdlog::level::from_str(key_values["flush_on"]);\
@@ -217,6 +301,274 @@ std::string LoggerConfig::FileConfig::GetFilename() const {
         flush_on_ = tmp;\
     }
 
+#define GET_QUEUE_SIZE() \
+    {\
+        auto tmp = key_values["queue_size"];\
+        for (auto c : tmp) {\
+            if (c < '0' || c > '9') {\
+                Log("Error: Value of key 'queue_size' is invalid");\
+                return false;\
+            }\
+        }\
+        queue_size_ = std::stoul(tmp);\
+        if (queue_size_ == 0) {\
+            Log("Error: Value of key 'queue_size' must be greater than 0");\
+            return false;\
+        }\
+    }
+
+#define GET_THREAD_COUNT() \
+    {\
+        auto tmp = key_values["thread_count"];\
+        for (auto c : tmp) {\
+            if (c < '0' || c > '9') {\
+                Log("Error: Value of key 'thread_count' is invalid");\
+                return false;\
+            }\
+        }\
+        thread_count_ = std::stoul(tmp);\
+        if (thread_count_ == 0 || thread_count_ > 1000) {\
+            Log("Error: Value of key 'thread_count' must be in range [1, 1000]");\
+            return false;\
+        }\
+    }
+
+#define GET_OVERFLOW_POLICY() \
+    {\
+        auto tmp = key_values["overflow_policy"];\
+        if (tmp == "block") {\
+            overflow_policy_ = spdlog::async_overflow_policy::block;\
+        }\
+        else if (tmp == "overrun_oldest") {\
+            overflow_policy_ = spdlog::async_overflow_policy::overrun_oldest;\
+        }\
+        else if (tmp == "discard_new") {\
+            overflow_policy_ = spdlog::async_overflow_policy::discard_new;\
+        }\
+        else if (tmp == "drop_below_level") {\
+            overflow_policy_ = spdlog::async_overflow_policy::drop_below_level;\
+        }\
+        else {\
+            Log("Error: Value of key 'overflow_policy' is invalid. (Acceptable: block, overrun_oldest, discard_new, drop_below_level)");\
+            return false;\
+        }\
+    }
+
+/* 可选 */
+#define GET_QUEUE_TYPE() \
+    if (key_values.find("queue_type") != key_values.end()) {\
+        auto tmp = key_values["queue_type"];\
+        if (tmp == "blocking") {\
+            queue_type_ = spdlog::details::async_queue_type::blocking;\
+        }\
+        else if (tmp == "lockfree") {\
+            queue_type_ = spdlog::details::async_queue_type::lockfree;\
+        }\
+        else if (tmp == "per_thread") {\
+            queue_type_ = spdlog::details::async_queue_type::per_thread;\
+        }\
+        else {\
+            Log("Error: Value of key 'queue_type' is invalid. (Acceptable: blocking, lockfree, per_thread)");\
+            return false;\
+        }\
+    }
+
+/* 可选 */
+#define GET_BATCH_SIZE() \
+    if (key_values.find("batch_size") != key_values.end()) {\
+        auto tmp = key_values["batch_size"];\
+        for (auto c : tmp) {\
+            if (c < '0' || c > '9') {\
+                Log("Error: Value of key 'batch_size' is invalid");\
+                return false;\
+            }\
+        }\
+        batch_size_ = tmp.empty() ? 0 : std::stoul(tmp);\
+        if (batch_size_ == 0) {\
+            Log("Error: Value of key 'batch_size' must be greater than 0");\
+            return false;\
+        }\
+    }
+
+/* 可选 */
+#define GET_DEFERRED_FORMAT() \
+    if (key_values.find("deferred_format") != key_values.end()) {\
+        auto tmp = key_values["deferred_format"];\
+        if (tmp == "true") {\
+            deferred_format_ = true;\
+        }\
+        else if (tmp == "false") {\
+            deferred_format_ = false;\
+        }\
+        else {\
+            Log("Error: Value of key 'deferred_format' is invalid. (Acceptable: true, false)");\
+            return false;\
+        }\
+    }
+
+/* 可选 */
+#define GET_ARENA_SIZE() \
+    if (key_values.find("arena_size") != key_values.end()) {\
+        uint64_t tmp;\
+        if (!util::parse_filesize(key_values["arena_size"], tmp)) {\
+            Log("Error: Value of key 'arena_size' is invalid");\
+            return false;\
+        }\
+        arena_size_ = static_cast<size_t>(tmp);\
+    }
+
+/* 可选 */
+#define GET_WAIT_STRATEGY() \
+    if (key_values.find("wait_strategy") != key_values.end()) {\
+        auto tmp = key_values["wait_strategy"];\
+        if (tmp == "blocking") {\
+            wait_strategy_ = spdlog::details::async_wait_strategy::blocking;\
+        }\
+        else if (tmp == "spin") {\
+            wait_strategy_ = spdlog::details::async_wait_strategy::spin;\
+        }\
+        else if (tmp == "spin_yield_park") {\
+            wait_strategy_ = spdlog::details::async_wait_strategy::spin_yield_park;\
+        }\
+        else if (tmp == "busy_poll") {\
+            wait_strategy_ = spdlog::details::async_wait_strategy::busy_poll;\
+        }\
+        else {\
+            Log("Error: Value of key 'wait_strategy' is invalid. (Acceptable: blocking, spin, spin_yield_park, busy_poll)");\
+            return false;\
+        }\
+    }
+
+/* 可选 */
+#define GET_COUNT(key, member) \
+    if (key_values.find(key) != key_values.end()) {\
+        auto tmp = key_values[key];\
+        if (tmp.empty()) {\
+            Log("Error: Value of key '" key "' is invalid");\
+            return false;\
+        }\
+        for (auto c : tmp) {\
+            if (c < '0' || c > '9') {\
+                Log("Error: Value of key '" key "' is invalid");\
+                return false;\
+            }\
+        }\
+        member = std::stoul(tmp);\
+    }
+
+/* 可选 */
+#define GET_THREAD_NAME() \
+    if (key_values.find("thread_name") != key_values.end()) {\
+        thread_name_ = key_values["thread_name"];\
+    }
+
+/* 可选 */
+#define GET_CPU_AFFINITY() \
+    if (key_values.find("cpu_affinity") != key_values.end()) {\
+        auto tmp = key_values["cpu_affinity"];\
+        cpu_affinity_.clear();\
+        if (!tmp.empty() && !util::parse_cpu_list(tmp, cpu_affinity_)) {\
+            Log("Error: Value of key 'cpu_affinity' is invalid. (e.g. 0,2,4-7)");\
+            return false;\
+        }\
+    }
+
+/* 可选 */
+#define GET_NICE() \
+    if (key_values.find("nice") != key_values.end()) {\
+        auto tmp = key_values["nice"];\
+        size_t start = (!tmp.empty() && tmp[0] == '-') ? 1 : 0;\
+        if (tmp.length() == start || tmp.length() > start + 2 ||\
+            tmp.find_first_not_of("0123456789", start) != std::string::npos)\
+        {\
+            Log("Error: Value of key 'nice' is invalid");\
+            return false;\
+        }\
+        nice_ = std::stoi(tmp);\
+        if (nice_ < -20 || nice_ > 19) {\
+            Log("Error: Value of key 'nice' must be in range [-20, 19]");\
+            return false;\
+        }\
+    }
+
+/* 可选 */
+#define GET_SCHED_IDLE() \
+    if (key_values.find("sched_idle") != key_values.end()) {\
+        auto tmp = key_values["sched_idle"];\
+        if (tmp == "true") {\
+            sched_idle_ = true;\
+        }\
+        else if (tmp == "false") {\
+            sched_idle_ = false;\
+        }\
+        else {\
+            Log("Error: Value of key 'sched_idle' is invalid. (Acceptable: true, false)");\
+            return false;\
+        }\
+    }
+
+/* 可选 */
+#define GET_PRIORITY_LEVEL() \
+    if (key_values.find("priority_level") != key_values.end()) {\
+        auto tmp = spdlog::level::from_str(key_values["priority_level"]);\
+        if (tmp == spdlog::level::off) {\
+            Log("Error: Value of key 'priority_level' is invalid");\
+            return false;\
+        }\
+        priority_level_ = tmp;\
+    }
+
+/* 可选 */
+#define GET_REPORT_DROPS() \
+    if (key_values.find("report_drops") != key_values.end()) {\
+        auto tmp = key_values["report_drops"];\
+        if (tmp == "true") {\
+            report_drops_ = true;\
+        }\
+        else if (tmp == "false") {\
+            report_drops_ = false;\
+        }\
+        else {\
+            Log("Error: Value of key 'report_drops' is invalid. (Acceptable: true, false)");\
+            return false;\
+        }\
+    }
+
+/* 可选 */
+#define GET_TELEMETRY() \
+    if (key_values.find("telemetry") != key_values.end()) {\
+        auto tmp = key_values["telemetry"];\
+        if (tmp == "true") {\
+            telemetry_ = true;\
+        }\
+        else if (tmp == "false") {\
+            telemetry_ = false;\
+        }\
+        else {\
+            Log("Error: Value of key 'telemetry' is invalid. (Acceptable: true, false)");\
+            return false;\
+        }\
+    }
+
+/* 可选 */
+#define GET_SHARDING() \
+    if (key_values.find("sharding") != key_values.end()) {\
+        auto tmp = key_values["sharding"];\
+        if (tmp == "none") {\
+            sharding_ = spdlog::details::async_sharding::none;\
+        }\
+        else if (tmp == "logger") {\
+            sharding_ = spdlog::details::async_sharding::logger;\
+        }\
+        else if (tmp == "sink") {\
+            sharding_ = spdlog::details::async_sharding::sink;\
+        }\
+        else {\
+            Log("Error: Value of key 'sharding' is invalid. (Acceptable: none, logger, sink)");\
+            return false;\
+        }\
+    }
+
 /**
  * @brief 从键值对读取配置信息.
  */
@@ -251,6 +603,46 @@ bool LoggerConfig::RotatingFileConfig::Parse(std::map<std::string, std::string>&
     return FileConfig::Parse(key_values);
 }
 
+bool LoggerConfig::MmapRingFileConfig::Parse(std::map<std::string, std::string>& key_values) {
+    static const char* s_mmap_ring_file_config_keys[] = { "ring_size" };
+    CHECK_KEY_VALUES(s_mmap_ring_file_config_keys);
+    GET_RING_SIZE();
+    return FileConfig::Parse(key_values);
+}
+
+bool LoggerConfig::AsyncConfig::Parse(std::map<std::string, std::string>& key_values) {
+    static const char* s_async_config_keys[] = { "queue_size", "thread_count", "overflow_policy" };
+    CHECK_KEY_VALUES(s_async_config_keys);
+    GET_QUEUE_SIZE();
+    GET_THREAD_COUNT();
+    GET_OVERFLOW_POLICY();
+    GET_QUEUE_TYPE();
+    GET_BATCH_SIZE();
+    GET_DEFERRED_FORMAT();
+    GET_ARENA_SIZE();
+    GET_WAIT_STRATEGY();
+    GET_COUNT("spin_count", spin_count_);
+    GET_COUNT("yield_count", yield_count_);
+    GET_THREAD_NAME();
+    GET_CPU_AFFINITY();
+    GET_NICE();
+    GET_SCHED_IDLE();
+    GET_SHARDING();
+    GET_PRIORITY_LEVEL();
+    GET_COUNT("reserved_items", reserved_items_);
+    GET_REPORT_DROPS();
+    GET_TELEMETRY();
+    if (queue_type_ == spdlog::details::async_queue_type::per_thread && thread_count_ != 1) {
+        Log("Error: Value of key 'thread_count' must be 1 when 'queue_type' is per_thread");
+        return false;
+    }
+    if (reserved_items_ >= queue_size_) {
+        Log("Error: Value of key 'reserved_items' must be less than 'queue_size'");
+        return false;
+    }
+    return true;
+}
+
 bool LoggerConfig::ParseBasic(std::map<std::string, std::string>& key_values) {
     static const char* s_basic_keys[] = { "name", "detailed_min", "flush_every", "flush_on" };
     CHECK_KEY_VALUES(s_basic_keys);
@@ -259,6 +651,8 @@ bool LoggerConfig::ParseBasic(std::map<std::string, std::string>& key_values) {
     GET_DETAILED_FILENAME_TYPE();
     GET_FLUSH_EVERY();
     GET_FLUSH_ON();
+    GET_STATS_EVERY();
+    GET_CRASH_HANDLER();
     return true;
 }
 
@@ -311,6 +705,22 @@ bool LoggerConfig::ReadFromFile(const std::string& filename) {
             }
             rotating_file_configs_.push_back(config);
         }
+        else if (util::starts_with(p.first, "mmap_ring")) {
+            MmapRingFileConfig config;
+            if (!config.Parse(p.second)) {
+                Log("Error: Parse section '{}' failed in file '{}'", p.first, filename);
+                return false;
+            }
+            mmap_ring_file_configs_.push_back(config);
+        }
+        else if (p.first == "async") {
+            AsyncConfig config;
+            if (!config.Parse(p.second)) {
+                Log("Error: Parse section '{}' failed in file '{}'", p.first, filename);
+                return false;
+            }
+            set_async_config(config);
+        }
         else {
             Log("Error: Unknown section '{}' in file '{}'", p.first, filename);
             return false;
@@ -356,6 +766,54 @@ std::map<std::string, std::string> LoggerConfig::RotatingFileConfig::Serialize()
     return FileConfig::Serialize();
 }
 
+std::map<std::string, std::string> LoggerConfig::MmapRingFileConfig::Serialize() const {
+    auto result = FileConfig::Serialize();
+    result["ring_size"] = util::format_filesize(ring_size_, 2);
+    return result;
+}
+
+std::map<std::string, std::string> LoggerConfig::AsyncConfig::Serialize() const {
+    std::map<std::string, std::string> result;
+    result["queue_size"] = std::to_string(queue_size_);
+    result["thread_count"] = std::to_string(thread_count_);
+    switch (overflow_policy_) {
+        case spdlog::async_overflow_policy::overrun_oldest:   result["overflow_policy"] = "overrun_oldest"; break;
+        case spdlog::async_overflow_policy::discard_new:      result["overflow_policy"] = "discard_new"; break;
+        case spdlog::async_overflow_policy::drop_below_level: result["overflow_policy"] = "drop_below_level"; break;
+        default:                                              result["overflow_policy"] = "block"; break;
+    }
+    switch (queue_type_) {
+        case spdlog::details::async_queue_type::lockfree:   result["queue_type"] = "lockfree"; break;
+        case spdlog::details::async_queue_type::per_thread: result["queue_type"] = "per_thread"; break;
+        default:                                            result["queue_type"] = "blocking"; break;
+    }
+    result["batch_size"] = std::to_string(batch_size_);
+    result["deferred_format"] = deferred_format_ ? "true" : "false";
+    result["arena_size"] = util::format_filesize(arena_size_, 2);
+    switch (wait_strategy_) {
+        case spdlog::details::async_wait_strategy::spin:            result["wait_strategy"] = "spin"; break;
+        case spdlog::details::async_wait_strategy::spin_yield_park: result["wait_strategy"] = "spin_yield_park"; break;
+        case spdlog::details::async_wait_strategy::busy_poll:       result["wait_strategy"] = "busy_poll"; break;
+        default:                                                    result["wait_strategy"] = "blocking"; break;
+    }
+    result["spin_count"] = std::to_string(spin_count_);
+    result["yield_count"] = std::to_string(yield_count_);
+    result["thread_name"] = thread_name_;
+    result["cpu_affinity"] = util::format_cpu_list(cpu_affinity_);
+    result["nice"] = std::to_string(nice_);
+    result["sched_idle"] = sched_idle_ ? "true" : "false";
+    switch (sharding_) {
+        case spdlog::details::async_sharding::logger: result["sharding"] = "logger"; break;
+        case spdlog::details::async_sharding::sink:   result["sharding"] = "sink"; break;
+        default:                                      result["sharding"] = "none"; break;
+    }
+    result["priority_level"] = level_to_string(priority_level_);
+    result["reserved_items"] = std::to_string(reserved_items_);
+    result["report_drops"] = report_drops_ ? "true" : "false";
+    result["telemetry"] = telemetry_ ? "true" : "false";
+    return result;
+}
+
 /**
  * @brief 序列化.
  */
@@ -368,6 +826,8 @@ std::map<std::string, std::map<std::string, std::string>> LoggerConfig::Serializ
         basic["detailed_min"] = detailed_min_;
         basic["flush_every"] = std::to_string(flush_every_);
         basic["flush_on"] = level_to_string(flush_on_);
+        basic["stats_every"] = std::to_string(stats_every_);
+        basic["crash_handler"] = crash_handler_ ? "true" : "false";
         result.emplace("basic", basic);
     }
     // console
@@ -388,6 +848,16 @@ std::map<std::string, std::map<std::string, std::string>> LoggerConfig::Serializ
         auto value = rotating_file_configs_[i].Serialize();
         result.emplace(name, value);
     }
+    // mmap_ring
+    for (size_t i = 0, count = mmap_ring_file_configs_.size(); i < count; ++i) {
+        auto name = "mmap_ring" + (count == 1 ? std::string() : std::string("-" + std::to_string(i+1)));
+        auto value = mmap_ring_file_configs_[i].Serialize();
+        result.emplace(name, value);
+    }
+    // async
+    if (async_) {
+        result.emplace("async", async_config_.Serialize());
+    }
     return result;
 }
 
@@ -396,7 +866,9 @@ std::map<std::string, std::map<std::string, std::string>> LoggerConfig::Serializ
  */
 LoggerConfig::LoggerConfig()
     : detailed_min_(CFG_DEFAULT_DETAILED_MIN), detailed_filename_type_(CFG_DEFAULT_DETAILED_FILENAME_TYPE),
-      flush_on_(CFG_DEFAULT_FLUSH_ON), flush_every_(CFG_DEFAULT_FLUSH_EVERY), name_(CFG_DEFAULT_NAME)
+      flush_on_(CFG_DEFAULT_FLUSH_ON), flush_every_(CFG_DEFAULT_FLUSH_EVERY),
+      stats_every_(CFG_DEFAULT_STATS_EVERY), crash_handler_(CFG_DEFAULT_CRASH_HANDLER), name_(CFG_DEFAULT_NAME),
+      async_(false)
 {
 }
 
@@ -263,6 +263,63 @@ std::string format_filesize(size_t size, unsigned int decimals) {
     return result;
 }
 
+/**
+ * @brief 解析CPU列表.
+ * 
+ * @param[in]  str CPU列表字符串（逗号分隔，支持范围，如 0,2,4-7）
+ * @param[out] cpus CPU编号
+ * @retval true 成功
+ * @retval false 失败，无效的字符串
+ */
+bool parse_cpu_list(std::string str, std::vector<int>& cpus) {
+    cpus.clear();
+    trim(str);
+    size_t start = 0;
+    while (start < str.length()) {
+        size_t end = str.find(',', start);
+        if (end == std::string::npos) {
+            end = str.length();
+        }
+        std::string item = str.substr(start, end - start);
+        trim(item);
+        size_t dash = item.find('-');
+        std::string first = item.substr(0, dash);
+        std::string last = (dash == std::string::npos) ? first : item.substr(dash + 1);
+        trim(first);
+        trim(last);
+        if (first.empty() || last.empty() || first.length() > 4 || last.length() > 4 ||
+            first.find_first_not_of("0123456789") != std::string::npos ||
+            last.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+        int from = std::stoi(first);
+        int to = std::stoi(last);
+        if (from > to) {
+            return false;
+        }
+        for (int cpu = from; cpu <= to; ++cpu) {
+            cpus.push_back(cpu);
+        }
+        start = end + 1;
+    }
+    return !cpus.empty();
+}
+
+/**
+ * @brief 格式化CPU列表（逗号分隔）.
+ */
+std::string format_cpu_list(const std::vector<int>& cpus) {
+    std::string result;
+    for (auto cpu : cpus) {
+        if (!result.empty()) {
+            result += ',';
+        }
+        result += std::to_string(cpu);
+    }
+    return result;
+}
+
 } // namespace util
 } // namespace log
 } // namespace ic
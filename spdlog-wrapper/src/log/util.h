@@ -77,6 +77,21 @@ bool parse_filesize(std::string str, uint64_t& size);
  */
 std::string format_filesize(size_t size, unsigned int decimals);
 
+/**
+ * @brief 解析CPU列表.
+ * 
+ * @param[in]  str CPU列表字符串（逗号分隔，支持范围，如 0,2,4-7）
+ * @param[out] cpus CPU编号
+ * @retval true 成功
+ * @retval false 失败，无效的字符串
+ */
+bool parse_cpu_list(std::string str, std::vector<int>& cpus);
+
+/**
+ * @brief 格式化CPU列表（逗号分隔）.
+ */
+std::string format_cpu_list(const std::vector<int>& cpus);
+
 /**
  * @brief 判断字符串str是否以字符串prefix开头.
  */
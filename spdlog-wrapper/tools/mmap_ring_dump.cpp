@@ -0,0 +1,28 @@
+/**
+ * @file mmap_ring_dump.cpp
+ * @brief 解码 mmap_ring 日志文件(spdlog::sinks::mmap_ring_sink)
+ * @details 按从旧到新的顺序输出环形缓冲区中完整的日志，已部分覆盖的最旧一条日志被跳过。
+ *          程序崩溃后，文件中保存着最后 ring_size 字节的日志。
+ *
+ *   用法: mmap_ring_dump.out <file>
+ */
+#include <spdlog/sinks/mmap_ring_sink.h>
+#include <cstdio>
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::fprintf(stderr, "Usage: %s <file>\n", argv[0]);
+        return 2;
+    }
+    try {
+        uint64_t sequence = 0;
+        std::string records = spdlog::read_mmap_ring_file(argv[1], &sequence);
+        std::fwrite(records.data(), 1, records.size(), stdout);
+        std::fprintf(stderr, "%s: %llu messages written in total\n", argv[1], static_cast<unsigned long long>(sequence));
+    }
+    catch (const std::exception& ex) {
+        std::fprintf(stderr, "%s\n", ex.what());
+        return 1;
+    }
+    return 0;
+}
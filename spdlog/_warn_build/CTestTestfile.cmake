@@ -0,0 +1,7 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/spdlog
+# Build directory: /root/repo/spdlog/_warn_build
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+subdirs("tests")
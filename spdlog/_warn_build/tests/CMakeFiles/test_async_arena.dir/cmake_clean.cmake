@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_async_arena.dir/test_async_arena.cpp.o"
+  "CMakeFiles/test_async_arena.dir/test_async_arena.cpp.o.d"
+  "test_async_arena"
+  "test_async_arena.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_async_arena.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
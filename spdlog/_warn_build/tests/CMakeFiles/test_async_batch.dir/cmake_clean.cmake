@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_async_batch.dir/test_async_batch.cpp.o"
+  "CMakeFiles/test_async_batch.dir/test_async_batch.cpp.o.d"
+  "test_async_batch"
+  "test_async_batch.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_async_batch.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_async_overflow.dir/test_async_overflow.cpp.o"
+  "CMakeFiles/test_async_overflow.dir/test_async_overflow.cpp.o.d"
+  "test_async_overflow"
+  "test_async_overflow.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_async_overflow.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
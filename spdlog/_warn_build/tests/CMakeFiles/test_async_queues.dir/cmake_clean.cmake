@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_async_queues.dir/test_async_queues.cpp.o"
+  "CMakeFiles/test_async_queues.dir/test_async_queues.cpp.o.d"
+  "test_async_queues"
+  "test_async_queues.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_async_queues.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_async_shutdown.dir/test_async_shutdown.cpp.o"
+  "CMakeFiles/test_async_shutdown.dir/test_async_shutdown.cpp.o.d"
+  "test_async_shutdown"
+  "test_async_shutdown.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_async_shutdown.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_deferred_format.dir/test_deferred_format.cpp.o"
+  "CMakeFiles/test_deferred_format.dir/test_deferred_format.cpp.o.d"
+  "test_deferred_format"
+  "test_deferred_format.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_deferred_format.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_drop_reports.dir/test_drop_reports.cpp.o"
+  "CMakeFiles/test_drop_reports.dir/test_drop_reports.cpp.o.d"
+  "test_drop_reports"
+  "test_drop_reports.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_drop_reports.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_formatter_sharing.dir/test_formatter_sharing.cpp.o"
+  "CMakeFiles/test_formatter_sharing.dir/test_formatter_sharing.cpp.o.d"
+  "test_formatter_sharing"
+  "test_formatter_sharing.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_formatter_sharing.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
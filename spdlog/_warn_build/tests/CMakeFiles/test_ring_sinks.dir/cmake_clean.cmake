@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_ring_sinks.dir/test_ring_sinks.cpp.o"
+  "CMakeFiles/test_ring_sinks.dir/test_ring_sinks.cpp.o.d"
+  "test_ring_sinks"
+  "test_ring_sinks.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_ring_sinks.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
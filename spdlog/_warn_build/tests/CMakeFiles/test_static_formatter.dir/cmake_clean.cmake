@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/test_static_formatter.dir/test_static_formatter.cpp.o"
+  "CMakeFiles/test_static_formatter.dir/test_static_formatter.cpp.o.d"
+  "test_static_formatter"
+  "test_static_formatter.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/test_static_formatter.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
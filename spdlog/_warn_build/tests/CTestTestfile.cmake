@@ -0,0 +1,26 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/spdlog/tests
+# Build directory: /root/repo/spdlog/_warn_build/tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(test_async_arena "/root/repo/spdlog/_warn_build/tests/test_async_arena")
+set_tests_properties(test_async_arena PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/spdlog/tests/CMakeLists.txt;25;add_test;/root/repo/spdlog/tests/CMakeLists.txt;0;")
+add_test(test_async_batch "/root/repo/spdlog/_warn_build/tests/test_async_batch")
+set_tests_properties(test_async_batch PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/spdlog/tests/CMakeLists.txt;25;add_test;/root/repo/spdlog/tests/CMakeLists.txt;0;")
+add_test(test_async_overflow "/root/repo/spdlog/_warn_build/tests/test_async_overflow")
+set_tests_properties(test_async_overflow PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/spdlog/tests/CMakeLists.txt;25;add_test;/root/repo/spdlog/tests/CMakeLists.txt;0;")
+add_test(test_async_queues "/root/repo/spdlog/_warn_build/tests/test_async_queues")
+set_tests_properties(test_async_queues PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/spdlog/tests/CMakeLists.txt;25;add_test;/root/repo/spdlog/tests/CMakeLists.txt;0;")
+add_test(test_async_shutdown "/root/repo/spdlog/_warn_build/tests/test_async_shutdown")
+set_tests_properties(test_async_shutdown PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/spdlog/tests/CMakeLists.txt;25;add_test;/root/repo/spdlog/tests/CMakeLists.txt;0;")
+add_test(test_deferred_format "/root/repo/spdlog/_warn_build/tests/test_deferred_format")
+set_tests_properties(test_deferred_format PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/spdlog/tests/CMakeLists.txt;25;add_test;/root/repo/spdlog/tests/CMakeLists.txt;0;")
+add_test(test_drop_reports "/root/repo/spdlog/_warn_build/tests/test_drop_reports")
+set_tests_properties(test_drop_reports PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/spdlog/tests/CMakeLists.txt;25;add_test;/root/repo/spdlog/tests/CMakeLists.txt;0;")
+add_test(test_formatter_sharing "/root/repo/spdlog/_warn_build/tests/test_formatter_sharing")
+set_tests_properties(test_formatter_sharing PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/spdlog/tests/CMakeLists.txt;25;add_test;/root/repo/spdlog/tests/CMakeLists.txt;0;")
+add_test(test_ring_sinks "/root/repo/spdlog/_warn_build/tests/test_ring_sinks")
+set_tests_properties(test_ring_sinks PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/spdlog/tests/CMakeLists.txt;25;add_test;/root/repo/spdlog/tests/CMakeLists.txt;0;")
+add_test(test_static_formatter "/root/repo/spdlog/_warn_build/tests/test_static_formatter")
+set_tests_properties(test_static_formatter PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/spdlog/tests/CMakeLists.txt;25;add_test;/root/repo/spdlog/tests/CMakeLists.txt;0;")
@@ -10,6 +10,8 @@
 #include <spdlog/sinks/sink.h>
 #include <spdlog/details/thread_pool.h>
 
+#include <chrono>
+#include <cstdio>
 #include <memory>
 #include <string>
 
@@ -26,52 +28,306 @@ SPDLOG_INLINE spdlog::async_logger::async_logger(
 // send the log message to the thread pool
 SPDLOG_INLINE void spdlog::async_logger::sink_it_(const details::log_msg &msg)
 {
-    if (auto pool_ptr = thread_pool_.lock())
+    post_log_(msg, nullptr);
+}
+
+SPDLOG_INLINE void spdlog::async_logger::set_deferred_formatting(bool enabled)
+{
+    deferred_formatting_ = enabled;
+}
+
+SPDLOG_INLINE bool spdlog::async_logger::deferred_formatting() const
+{
+    return deferred_formatting_;
+}
+
+// send the encoded message to the thread pool, the worker formats it
+SPDLOG_INLINE void spdlog::async_logger::sink_deferred_(const details::log_msg &msg, details::deferred_format_fn format_fn)
+{
+    post_log_(msg, format_fn);
+}
+
+SPDLOG_INLINE void spdlog::async_logger::post_log_(const details::log_msg &msg, details::deferred_format_fn format_fn)
+{
+    auto pool_ptr = thread_pool_.lock();
+    if (!pool_ptr)
     {
-        pool_ptr->post_log(shared_from_this(), msg, overflow_policy_);
+        throw_spdlog_ex("async log: thread pool doesn't exist anymore");
     }
-    else
+    if (sink_shards_.empty())
     {
-        throw_spdlog_ex("async log: thread pool doesn't exist anymore");
+        pool_ptr->post_log(shared_from_this(), msg, overflow_policy_, format_fn, shard_);
+        return;
+    }
+
+    // sink sharding: one copy per worker owning a sink that wants this message
+    for (size_t i = 0; i < sinks_.size(); i++)
+    {
+        if (!sinks_[i]->should_log(msg.level))
+        {
+            continue;
+        }
+        size_t shard = sink_shard_(i);
+        bool posted = false;
+        for (size_t j = 0; j < i && !posted; j++)
+        {
+            posted = sink_shard_(j) == shard && sinks_[j]->should_log(msg.level);
+        }
+        if (!posted)
+        {
+            pool_ptr->post_log(shared_from_this(), msg, overflow_policy_, format_fn, shard);
+        }
     }
 }
 
-// send flush request to the thread pool
+// send flush request to the thread pool (to each worker owning one of the sinks)
 SPDLOG_INLINE void spdlog::async_logger::flush_()
 {
-    if (auto pool_ptr = thread_pool_.lock())
+    auto pool_ptr = thread_pool_.lock();
+    if (!pool_ptr)
+    {
+        throw_spdlog_ex("async flush: thread pool doesn't exist anymore");
+    }
+    if (sink_shards_.empty())
     {
-        pool_ptr->post_flush(shared_from_this(), overflow_policy_);
+        pool_ptr->post_flush(shared_from_this(), overflow_policy_, shard_);
+        return;
     }
-    else
+    for (size_t i = 0; i < sinks_.size(); i++)
     {
-        throw_spdlog_ex("async flush: thread pool doesn't exist anymore");
+        size_t shard = sink_shard_(i);
+        bool posted = false;
+        for (size_t j = 0; j < i && !posted; j++)
+        {
+            posted = sink_shard_(j) == shard;
+        }
+        if (!posted)
+        {
+            pool_ptr->post_flush(shared_from_this(), overflow_policy_, shard);
+        }
     }
 }
 
+SPDLOG_INLINE void spdlog::async_logger::assign_shards_()
+{
+    auto pool_ptr = thread_pool_.lock();
+    if (!pool_ptr || pool_ptr->shards_count() == 1)
+    {
+        return;
+    }
+    if (pool_ptr->sharding() == details::async_sharding::logger)
+    {
+        shard_ = pool_ptr->assign_shard(this);
+    }
+    else if (pool_ptr->sharding() == details::async_sharding::sink)
+    {
+        for (auto &sink : sinks_)
+        {
+            sink_shards_.push_back(pool_ptr->assign_shard(sink.get()));
+        }
+        // sinks added later go to the worker of the first sink
+        shard_ = sink_shards_.empty() ? pool_ptr->assign_shard(this) : sink_shards_[0];
+        if (sink_shards_.empty())
+        {
+            sink_shards_.push_back(shard_);
+        }
+        drop_reports_.resize(pool_ptr->shards_count());
+    }
+}
+
+SPDLOG_INLINE size_t spdlog::async_logger::sink_shard_(size_t sink_index) const
+{
+    return sink_index < sink_shards_.size() ? sink_shards_[sink_index] : shard_;
+}
+
+// true if the sink is handled by the given worker
+SPDLOG_INLINE bool spdlog::async_logger::owns_sink_(size_t sink_index, size_t shard) const
+{
+    return sink_shards_.empty() || sink_shard_(sink_index) == shard;
+}
+
 //
 // backend functions - called from the thread pool to do the actual job
 //
 SPDLOG_INLINE void spdlog::async_logger::backend_sink_it_(const details::log_msg &msg)
 {
-    for (auto &sink : sinks_)
+    log_to_sinks_(msg);
+
+    if (should_flush_(msg))
+    {
+        backend_flush_();
+    }
+}
+
+SPDLOG_INLINE void spdlog::async_logger::backend_report_drops_(size_t shard)
+{
+    auto &drops = drop_report_(shard);
+    // since is read while the count is not zero: no new first drop can overwrite it until the exchange
+    if (drops.count.load(std::memory_order_acquire) == 0)
+    {
+        return;
+    }
+    log_clock::time_point since{log_clock::duration{drops.since.load(std::memory_order_relaxed)}};
+    size_t count = drops.count.exchange(0, std::memory_order_acquire);
+    if (count == 0)
+    {
+        return;
+    }
+
+    auto tm_time = details::os::localtime(log_clock::to_time_t(since));
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(since.time_since_epoch()).count() % 1000;
+    char buf[128];
+    int len = std::snprintf(buf, sizeof(buf), "dropped %zu messages (%s) since %02d:%02d:%02d.%03d", count,
+        overflow_policy_ == async_overflow_policy::overrun_oldest ? "overrun" : "queue full", tm_time.tm_hour, tm_time.tm_min,
+        tm_time.tm_sec, static_cast<int>(millis));
+    if (len <= 0)
+    {
+        return;
+    }
+    details::log_msg report(name_, level::warn, string_view_t(buf, static_cast<size_t>(len)));
+    const details::log_msg *report_ptr = &report;
+    backend_sink_batch_(&report_ptr, 1, shard);
+}
+
+// called by the pool (from any thread) when a message of this logger is dropped from the given worker's queue
+SPDLOG_INLINE bool spdlog::async_logger::note_dropped_(log_clock::time_point time, size_t shard)
+{
+    auto &drops = drop_report_(shard);
+    size_t count = drops.count.load(std::memory_order_relaxed);
+    do
+    {
+        // first drop: publish the time with the count
+        if (count == 0)
+        {
+            drops.since.store(time.time_since_epoch().count(), std::memory_order_relaxed);
+        }
+    } while (!drops.count.compare_exchange_weak(count, count + 1, std::memory_order_release, std::memory_order_relaxed));
+    return count == 0;
+}
+
+SPDLOG_INLINE spdlog::async_logger::drop_report &spdlog::async_logger::drop_report_(size_t shard)
+{
+    return sink_shards_.empty() ? drop_reports_[0] : drop_reports_[shard];
+}
+
+// replace the encoded arguments of a deferred message with the formatted text.
+// return false if formatting failed (the error handler was called)
+SPDLOG_INLINE bool spdlog::async_logger::backend_format_(details::async_msg &msg)
+{
+    SPDLOG_TRY
+    {
+        memory_buf_t buf;
+        msg.format_fn(buf, msg.payload);
+        msg.set_payload(string_view_t(buf.data(), buf.size()));
+        msg.format_fn = nullptr;
+        return true;
+    }
+    SPDLOG_LOGGER_CATCH(msg.source)
+    return false;
+}
+
+// consecutive messages of this logger drained at once by the worker
+// (only the sinks owned by the given worker when the pool is sharded by sink).
+// sinks with the same formatter id share one formatted copy of the batch, as in log_to_sinks_()
+SPDLOG_INLINE void spdlog::async_logger::backend_sink_batch_(const details::log_msg *const *msgs, size_t count, size_t shard)
+{
+    // the batch formatted by a formatter of id shared_id: the bytes of each message, with the color range it set
+    memory_buf_t shared;
+    std::vector<string_view_t> shared_views;
+    std::vector<std::pair<size_t, size_t>> shared_color_ranges;
+    size_t shared_id = 0;
+    for (size_t i = 0; i < sinks_.size(); i++)
     {
-        if (sink->should_log(msg.level))
+        if (!owns_sink_(i, shard))
         {
-            SPDLOG_TRY
+            continue;
+        }
+        auto &sink = sinks_[i];
+        SPDLOG_TRY
+        {
+            size_t id = sinks_.size() > 1 ? sink->formatter_id() : 0;
+            if (id != 0 && id != shared_id && shares_batch_formatter_(i, id, shard))
+            {
+                shared_id = format_batch_(i, msgs, count, shard, shared, shared_views, shared_color_ranges);
+            }
+            if (id != 0 && id == shared_id)
+            {
+                for (size_t j = 0; j < count; j++)
+                {
+                    msgs[j]->color_range_start = shared_color_ranges[j].first;
+                    msgs[j]->color_range_end = shared_color_ranges[j].second;
+                }
+                sink->log_batch_formatted(msgs, shared_views.data(), count, shared_id);
+            }
+            else
             {
-                sink->log(msg);
+                sink->log_batch(msgs, count);
             }
-            SPDLOG_LOGGER_CATCH(msg.source)
         }
+        SPDLOG_LOGGER_CATCH(source_loc())
     }
 
-    if (should_flush_(msg))
+    for (size_t i = 0; i < count; i++)
     {
-        backend_flush_();
+        if (should_flush_(*msgs[i]))
+        {
+            backend_flush_(shard);
+            break;
+        }
     }
 }
 
+// true if a sink after sinks_[index] owned by the given worker has the given formatter id
+SPDLOG_INLINE bool spdlog::async_logger::shares_batch_formatter_(size_t index, size_t formatter_id, size_t shard) const
+{
+    for (size_t i = index + 1; i < sinks_.size(); i++)
+    {
+        if (owns_sink_(i, shard) && sinks_[i]->formatter_id() == formatter_id)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// format the messages of the batch logged by sinks_[index] or a later sink of the same formatter id
+// with the formatter of sinks_[index]. return the id of that formatter, 0 if it changed in the meantime.
+SPDLOG_INLINE size_t spdlog::async_logger::format_batch_(size_t index, const details::log_msg *const *msgs, size_t count, size_t shard,
+    memory_buf_t &dest, std::vector<string_view_t> &views, std::vector<std::pair<size_t, size_t>> &color_ranges)
+{
+    size_t formatter_id = sinks_[index]->formatter_id();
+    std::vector<size_t> ends(count, 0);
+    color_ranges.assign(count, std::make_pair(size_t(0), size_t(0)));
+    dest.clear();
+    for (size_t j = 0; j < count; j++)
+    {
+        bool wanted = false;
+        for (size_t i = index; i < sinks_.size() && !wanted; i++)
+        {
+            wanted = owns_sink_(i, shard) && sinks_[i]->formatter_id() == formatter_id && sinks_[i]->should_log(msgs[j]->level);
+        }
+        if (wanted)
+        {
+            msgs[j]->color_range_start = 0;
+            msgs[j]->color_range_end = 0;
+            if (sinks_[index]->format(*msgs[j], dest) != formatter_id)
+            {
+                return 0;
+            }
+            color_ranges[j] = std::make_pair(msgs[j]->color_range_start, msgs[j]->color_range_end);
+        }
+        ends[j] = dest.size();
+    }
+    // the buffer does not move anymore
+    views.resize(count);
+    for (size_t j = 0; j < count; j++)
+    {
+        size_t begin = j == 0 ? 0 : ends[j - 1];
+        views[j] = string_view_t(dest.data() + begin, ends[j] - begin);
+    }
+    return formatter_id;
+}
+
 SPDLOG_INLINE void spdlog::async_logger::backend_flush_()
 {
     for (auto &sink : sinks_)
@@ -84,6 +340,22 @@ SPDLOG_INLINE void spdlog::async_logger::backend_flush_()
     }
 }
 
+SPDLOG_INLINE void spdlog::async_logger::backend_flush_(size_t shard)
+{
+    for (size_t i = 0; i < sinks_.size(); i++)
+    {
+        if (!owns_sink_(i, shard))
+        {
+            continue;
+        }
+        SPDLOG_TRY
+        {
+            sinks_[i]->flush();
+        }
+        SPDLOG_LOGGER_CATCH(source_loc())
+    }
+}
+
 SPDLOG_INLINE std::shared_ptr<spdlog::logger> spdlog::async_logger::clone(std::string new_name)
 {
     auto cloned = std::make_shared<spdlog::async_logger>(*this);
@@ -16,19 +16,27 @@
 
 #include <spdlog/logger.h>
 
+#include <atomic>
+#include <utility>
+#include <vector>
+
 namespace spdlog {
 
 // Async overflow policy - block by default.
 enum class async_overflow_policy
 {
-    block,         // Block until message can be enqueued
-    overrun_oldest // Discard oldest message in the queue if full when trying to
-                   // add new item.
+    block,           // Block until message can be enqueued
+    overrun_oldest,  // Discard oldest message in the queue if full when trying to
+                     // add new item.
+    discard_new,     // Discard the new message if the queue is full (never blocks)
+    drop_below_level // Discard new messages below the pool's priority level if the
+                     // queue is full, block for the others.
 };
 
 namespace details {
 class thread_pool;
-}
+struct async_msg;
+} // namespace details
 
 class SPDLOG_API async_logger final : public std::enable_shared_from_this<async_logger>, public logger
 {
@@ -41,7 +49,9 @@ public:
         : logger(std::move(logger_name), begin, end)
         , thread_pool_(std::move(tp))
         , overflow_policy_(overflow_policy)
-    {}
+    {
+        assign_shards_();
+    }
 
     async_logger(std::string logger_name, sinks_init_list sinks_list, std::weak_ptr<details::thread_pool> tp,
         async_overflow_policy overflow_policy = async_overflow_policy::block);
@@ -51,15 +61,57 @@ public:
 
     std::shared_ptr<logger> clone(std::string new_name) override;
 
+    // format messages on the worker thread instead of the calling thread.
+    // the caller only copies the format string and the arguments (strings inline, numbers and
+    // void pointers by value); calls with other argument types are still formatted by the caller.
+    // not thread safe, should be set before logging.
+    void set_deferred_formatting(bool enabled);
+    bool deferred_formatting() const;
+
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_deferred_(const details::log_msg &msg, details::deferred_format_fn format_fn) override;
     void flush_() override;
     void backend_sink_it_(const details::log_msg &incoming_log_msg);
+    bool backend_format_(details::async_msg &msg);
+    void backend_sink_batch_(const details::log_msg *const *msgs, size_t count, size_t shard);
     void backend_flush_();
+    void backend_flush_(size_t shard);
+    // log a "dropped N messages" warning to the sinks of the given worker if its messages of this
+    // logger were dropped since the last report
+    void backend_report_drops_(size_t shard);
 
 private:
     std::weak_ptr<details::thread_pool> thread_pool_;
     async_overflow_policy overflow_policy_;
+    // sharded pools: worker of this logger, and of each sink (sink sharding only)
+    size_t shard_ = 0;
+    std::vector<size_t> sink_shards_;
+
+    // messages of this logger dropped by the pool's overflow policy since the last report, per worker
+    // with sink sharding (each worker reports to its own sinks), a single one otherwise
+    // (a copy of the logger starts with no drops)
+    struct drop_report
+    {
+        std::atomic<size_t> count{0};
+        // log time of the first dropped message, stored before the count leaves zero
+        std::atomic<log_clock::rep> since{0};
+
+        drop_report() = default;
+        drop_report(const drop_report &) {}
+    };
+    std::vector<drop_report> drop_reports_ = std::vector<drop_report>(1);
+
+    // return true for the first drop since the last report
+    bool note_dropped_(log_clock::time_point time, size_t shard);
+    drop_report &drop_report_(size_t shard);
+    void assign_shards_();
+    size_t sink_shard_(size_t sink_index) const;
+    bool owns_sink_(size_t sink_index, size_t shard) const;
+    bool shares_batch_formatter_(size_t index, size_t formatter_id, size_t shard) const;
+    size_t format_batch_(size_t index, const details::log_msg *const *msgs, size_t count, size_t shard, memory_buf_t &dest,
+        std::vector<string_view_t> &views, std::vector<std::pair<size_t, size_t>> &color_ranges);
+    void post_log_(const details::log_msg &msg, details::deferred_format_fn format_fn);
 };
 } // namespace spdlog
 
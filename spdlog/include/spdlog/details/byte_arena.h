@@ -0,0 +1,157 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// pre allocated byte ring for variable length async message payloads.
+// allocate(..) - bump the head, wrapping to the start of the ring when the block doesn't fit
+// at the end. return nullptr if no room left (the caller falls back to the heap).
+// deallocate(..) - mark the block as released. blocks may be released in any order,
+// but their space is reclaimed in allocation (FIFO) order by the next allocate(..).
+// allocations from several threads are serialized by a spin lock (a few instructions, no system
+// calls). an arena with a single allocating thread (e.g. the ring of one producer) takes no lock.
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+
+namespace spdlog {
+namespace details {
+
+class byte_arena
+{
+public:
+    explicit byte_arena(size_t capacity, bool shared = true)
+        : capacity_(round_up_pow2_(capacity))
+        , mask_(capacity_ - 1)
+        , shared_(shared)
+        , buffer_(new char[capacity_])
+    {}
+
+    byte_arena(const byte_arena &) = delete;
+    byte_arena &operator=(const byte_arena &) = delete;
+
+    char *allocate(size_t size)
+    {
+        size_t needed = (block_unit + size + block_unit - 1) & ~(block_unit - 1);
+        if (needed > capacity_)
+        {
+            return nullptr;
+        }
+
+        lock_();
+        reclaim_();
+        size_t offset = head_ & mask_;
+        // not enough room before the end of the ring: skip to the start
+        size_t skipped = offset + needed > capacity_ ? capacity_ - offset : 0;
+        if (head_ + skipped + needed - tail_ > capacity_)
+        {
+            unlock_();
+            return nullptr;
+        }
+        if (skipped != 0)
+        {
+            auto *padding = new (buffer_at_(head_)) block_header(skipped);
+            padding->released.store(true, std::memory_order_relaxed);
+            head_ += skipped;
+        }
+        auto *header = new (buffer_at_(head_)) block_header(needed);
+        head_ += needed;
+        unlock_();
+        return reinterpret_cast<char *>(header) + block_unit;
+    }
+
+    void deallocate(char *p)
+    {
+        auto *header = reinterpret_cast<block_header *>(p - block_unit);
+        header->released.store(true, std::memory_order_release);
+    }
+
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+private:
+    // blocks (header + data) are multiples of block_unit, so headers are always aligned
+    static const size_t block_unit = 16;
+
+    struct block_header
+    {
+        explicit block_header(size_t block_size)
+            : size(block_size)
+        {}
+
+        size_t size;
+        std::atomic<bool> released{false};
+    };
+    static_assert(sizeof(block_header) <= block_unit, "block_header must fit in block_unit");
+
+    // advance the tail over the released blocks (must hold the lock)
+    void reclaim_()
+    {
+        while (tail_ != head_)
+        {
+            auto *header = reinterpret_cast<block_header *>(buffer_at_(tail_));
+            if (!header->released.load(std::memory_order_acquire))
+            {
+                break;
+            }
+            tail_ += header->size;
+        }
+    }
+
+    char *buffer_at_(size_t pos)
+    {
+        return buffer_.get() + (pos & mask_);
+    }
+
+    void lock_()
+    {
+        if (!shared_)
+        {
+            return;
+        }
+        for (int spins = 0; lock_flag_.test_and_set(std::memory_order_acquire); spins++)
+        {
+            if (spins >= spin_limit)
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void unlock_()
+    {
+        if (shared_)
+        {
+            lock_flag_.clear(std::memory_order_release);
+        }
+    }
+
+    static size_t round_up_pow2_(size_t n)
+    {
+        size_t result = 64;
+        while (result < n)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    static const int spin_limit = 64;
+
+    const size_t capacity_;
+    const size_t mask_;
+    // allocate(..) may be called from several threads
+    const bool shared_;
+    std::unique_ptr<char[]> buffer_;
+    std::atomic_flag lock_flag_ = ATOMIC_FLAG_INIT;
+    // absolute positions, the ring offset is pos & mask_
+    size_t head_ = 0;
+    size_t tail_ = 0;
+};
+} // namespace details
+} // namespace spdlog
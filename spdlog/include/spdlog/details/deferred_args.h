@@ -0,0 +1,165 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Deferred formatting support for async loggers.
+// The calling thread only encodes the format string and the arguments into a flat buffer
+// (strings are copied inline, arithmetic values and void pointers are stored by value),
+// the matching format function decodes them and runs fmt on the backend thread.
+//
+// Encoded layout: [size_t fmt size][fmt chars] then for each argument either
+// [sizeof(T) value bytes] or [size_t string size][string chars].
+// Calls with any other argument type are not deferrable and are formatted by the caller.
+
+#include <spdlog/common.h>
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+namespace spdlog {
+namespace details {
+
+// formats an encoded message (format string followed by its arguments) into dest
+using deferred_format_fn = void (*)(memory_buf_t &dest, string_view_t encoded);
+
+#ifndef SPDLOG_USE_STD_FORMAT
+namespace deferred {
+
+inline void append_bytes(memory_buf_t &dest, const void *data, size_t size)
+{
+    auto *begin = static_cast<const char *>(data);
+    dest.append(begin, begin + size);
+}
+
+inline void encode_string(memory_buf_t &dest, const char *data, size_t size)
+{
+    append_bytes(dest, &size, sizeof(size));
+    dest.append(data, data + size);
+}
+
+inline string_view_t decode_string(const char *&p)
+{
+    size_t size;
+    std::memcpy(&size, p, sizeof(size));
+    p += sizeof(size);
+    string_view_t result(p, size);
+    p += size;
+    return result;
+}
+
+template<typename T, typename Enable = void>
+struct arg_codec
+{
+    static const bool supported = false;
+};
+
+// arithmetic values and void pointers: stored by value
+template<typename T>
+struct arg_codec<T, typename std::enable_if<std::is_arithmetic<T>::value || std::is_same<T, const void *>::value ||
+                                            std::is_same<T, void *>::value>::type>
+{
+    static const bool supported = true;
+    using decoded_type = T;
+
+    static void encode(memory_buf_t &dest, const T &value)
+    {
+        append_bytes(dest, &value, sizeof(T));
+    }
+
+    static T decode(const char *&p)
+    {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+};
+
+// strings: copied inline, decoded as a view into the encoded buffer
+template<typename T>
+struct arg_codec<T, typename std::enable_if<std::is_same<T, const char *>::value || std::is_same<T, char *>::value>::type>
+{
+    static const bool supported = true;
+    using decoded_type = string_view_t;
+
+    static void encode(memory_buf_t &dest, const char *value)
+    {
+        // fmt rejects null strings, keep the message and log an empty one
+        encode_string(dest, value, value == nullptr ? 0 : std::strlen(value));
+    }
+
+    static string_view_t decode(const char *&p)
+    {
+        return decode_string(p);
+    }
+};
+
+template<typename T>
+struct arg_codec<T, typename std::enable_if<std::is_same<T, std::string>::value || std::is_same<T, string_view_t>::value>::type>
+{
+    static const bool supported = true;
+    using decoded_type = string_view_t;
+
+    static void encode(memory_buf_t &dest, const T &value)
+    {
+        encode_string(dest, value.data(), value.size());
+    }
+
+    static string_view_t decode(const char *&p)
+    {
+        return decode_string(p);
+    }
+};
+
+// true if every argument type can be encoded
+template<typename... Args>
+struct all_supported;
+
+template<>
+struct all_supported<> : std::true_type
+{};
+
+template<typename Head, typename... Tail>
+struct all_supported<Head, Tail...> : std::integral_constant<bool, arg_codec<Head>::supported && all_supported<Tail...>::value>
+{};
+
+template<typename... Args>
+struct type_list
+{};
+
+template<typename... Args>
+void encode(memory_buf_t &dest, string_view_t fmt, const Args &... args)
+{
+    encode_string(dest, fmt.data(), fmt.size());
+    int expand[] = {0, (arg_codec<Args>::encode(dest, args), 0)...};
+    (void)expand;
+}
+
+template<typename... Decoded>
+void decode_and_format(memory_buf_t &dest, string_view_t fmt, const char *, type_list<>, const Decoded &... decoded)
+{
+    fmt::detail::vformat_to(dest, fmt, fmt::make_format_args(decoded...));
+}
+
+template<typename Head, typename... Tail, typename... Decoded>
+void decode_and_format(memory_buf_t &dest, string_view_t fmt, const char *p, type_list<Head, Tail...>, const Decoded &... decoded)
+{
+    typename arg_codec<Head>::decoded_type value = arg_codec<Head>::decode(p);
+    decode_and_format(dest, fmt, p, type_list<Tail...>(), decoded..., value);
+}
+
+// deferred_format_fn for the given (decayed) argument types
+template<typename... Args>
+void format(memory_buf_t &dest, string_view_t encoded)
+{
+    const char *p = encoded.data();
+    string_view_t fmt = decode_string(p);
+    decode_and_format(dest, fmt, p, type_list<Args...>());
+}
+
+} // namespace deferred
+#endif
+} // namespace details
+} // namespace spdlog
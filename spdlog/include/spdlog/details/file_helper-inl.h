@@ -90,6 +90,15 @@ SPDLOG_INLINE void file_helper::flush()
     }
 }
 
+SPDLOG_INLINE void file_helper::sync()
+{
+    flush();
+    if (!os::fsync(fd_))
+    {
+        throw_spdlog_ex("Failed fsync file " + os::filename_to_str(filename_), errno);
+    }
+}
+
 SPDLOG_INLINE void file_helper::close()
 {
     if (fd_ != nullptr)
@@ -111,9 +120,13 @@ SPDLOG_INLINE void file_helper::close()
 
 SPDLOG_INLINE void file_helper::write(const memory_buf_t &buf)
 {
-    size_t msg_size = buf.size();
-    auto data = buf.data();
-    if (std::fwrite(data, 1, msg_size, fd_) != msg_size)
+    write(string_view_t(buf.data(), buf.size()));
+}
+
+SPDLOG_INLINE void file_helper::write(string_view_t data)
+{
+    size_t msg_size = data.size();
+    if (std::fwrite(data.data(), 1, msg_size, fd_) != msg_size)
     {
         throw_spdlog_ex("Failed writing to file " + os::filename_to_str(filename_), errno);
     }
@@ -133,6 +146,11 @@ SPDLOG_INLINE const filename_t &file_helper::filename() const
     return filename_;
 }
 
+SPDLOG_INLINE std::FILE *file_helper::stream() const
+{
+    return fd_;
+}
+
 //
 // return file path and its extension:
 //
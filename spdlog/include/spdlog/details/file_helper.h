@@ -26,10 +26,15 @@ public:
     void open(const filename_t &fname, bool truncate = false);
     void reopen(bool truncate);
     void flush();
+    // flush, then fsync the file
+    void sync();
     void close();
     void write(const memory_buf_t &buf);
+    void write(string_view_t data);
     size_t size() const;
     const filename_t &filename() const;
+    // the open stream (nullptr if closed)
+    std::FILE *stream() const;
 
     //
     // return file path and its extension:
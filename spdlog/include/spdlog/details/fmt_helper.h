@@ -3,6 +3,9 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
 #include <type_traits>
 #include <iterator>
 #include <spdlog/fmt/fmt.h>
@@ -13,6 +16,12 @@
 #    include <limits>
 #endif
 
+// SSE2 is part of x86-64 (and of x86 builds with /arch:SSE2 or -msse2): no runtime check needed
+#if !defined(SPDLOG_NO_SSE2) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#    define SPDLOG_SSE2_DIGITS
+#    include <emmintrin.h>
+#endif
+
 // Some fmt helpers to efficiently format and pad ints and strings
 namespace spdlog {
 namespace details {
@@ -122,16 +131,33 @@ inline void pad_uint(T n, unsigned int width, memory_buf_t &dest)
     append_int(n, dest);
 }
 
+// "000" "001" ... "999", built by string literal concatenation
+#define SPDLOG_DIGITS_10_(p) p "0" p "1" p "2" p "3" p "4" p "5" p "6" p "7" p "8" p "9"
+#define SPDLOG_DIGITS_100_(p)                                                                                                              \
+    SPDLOG_DIGITS_10_(p "0") SPDLOG_DIGITS_10_(p "1") SPDLOG_DIGITS_10_(p "2") SPDLOG_DIGITS_10_(p "3") SPDLOG_DIGITS_10_(p "4")           \
+        SPDLOG_DIGITS_10_(p "5") SPDLOG_DIGITS_10_(p "6") SPDLOG_DIGITS_10_(p "7") SPDLOG_DIGITS_10_(p "8") SPDLOG_DIGITS_10_(p "9")
+
+// the 3 digits of n (n < 1000), zero padded
+inline const char *digits3(uint32_t n)
+{
+    static const char table[] = SPDLOG_DIGITS_100_("0") SPDLOG_DIGITS_100_("1") SPDLOG_DIGITS_100_("2") SPDLOG_DIGITS_100_("3")
+        SPDLOG_DIGITS_100_("4") SPDLOG_DIGITS_100_("5") SPDLOG_DIGITS_100_("6") SPDLOG_DIGITS_100_("7") SPDLOG_DIGITS_100_("8")
+            SPDLOG_DIGITS_100_("9");
+    static_assert(sizeof(table) == 3001, "3 digits for each of 000-999");
+    return table + 3 * n;
+}
+
+#undef SPDLOG_DIGITS_100_
+#undef SPDLOG_DIGITS_10_
+
 template<typename T>
 inline void pad3(T n, memory_buf_t &dest)
 {
     static_assert(std::is_unsigned<T>::value, "pad3 must get unsigned T");
     if (n < 1000)
     {
-        dest.push_back(static_cast<char>(n / 100 + '0'));
-        n = n % 100;
-        dest.push_back(static_cast<char>((n / 10) + '0'));
-        dest.push_back(static_cast<char>((n % 10) + '0'));
+        const char *digits = digits3(static_cast<uint32_t>(n));
+        dest.append(digits, digits + 3);
     }
     else
     {
@@ -139,16 +165,101 @@ inline void pad3(T n, memory_buf_t &dest)
     }
 }
 
+#ifdef SPDLOG_SSE2_DIGITS
+// the 8 digits of n (n < 100000000) in the 16 bit lanes, most significant first.
+// n / 10000 and n % 10000 by multiplication, then each half divided by 1000, 100, 10 and 1 at once
+// (multiply high by the reciprocals, then by the shift correcting their scale) and the tens removed.
+inline __m128i digits8_sse2(uint32_t n)
+{
+    const __m128i abcdefgh = _mm_cvtsi32_si128(static_cast<int>(n));
+    const __m128i abcd = _mm_srli_epi64(_mm_mul_epu32(abcdefgh, _mm_set1_epi32(static_cast<int>(0xd1b71759))), 45);
+    const __m128i efgh = _mm_sub_epi32(abcdefgh, _mm_mul_epu32(abcd, _mm_set1_epi32(10000)));
+    // [abcd * 4 x 4, efgh * 4 x 4]
+    const __m128i v1 = _mm_slli_epi64(_mm_unpacklo_epi16(abcd, efgh), 2);
+    const __m128i v2 = _mm_unpacklo_epi16(v1, v1);
+    const __m128i v3 = _mm_unpacklo_epi32(v2, v2);
+    // [a, ab, abc, abcd, e, ef, efg, efgh]
+    const short top = static_cast<short>(0x8000);
+    const __m128i v4 = _mm_mulhi_epu16(v3, _mm_set_epi16(top, 13108, 5243, 8389, top, 13108, 5243, 8389));
+    const __m128i v5 = _mm_mulhi_epu16(v4, _mm_set_epi16(top, 8192, 2048, 128, top, 8192, 2048, 128));
+    // minus 10 times the lane before: [a, b, c, d, e, f, g, h]
+    const __m128i v6 = _mm_slli_epi64(_mm_mullo_epi16(v5, _mm_set1_epi16(10)), 16);
+    return _mm_sub_epi16(v5, v6);
+}
+#endif
+
+// write the 8 digits of n (n < 100000000), zero padded
+inline void write_digits8(char *dest, uint32_t n)
+{
+#ifdef SPDLOG_SSE2_DIGITS
+    const __m128i digits = _mm_packus_epi16(digits8_sse2(n), _mm_setzero_si128());
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(dest), _mm_add_epi8(digits, _mm_set1_epi8('0')));
+#else
+    std::memcpy(dest, digits3(n / 1000000) + 1, 2);
+    std::memcpy(dest + 2, digits3(n / 1000 % 1000), 3);
+    std::memcpy(dest + 5, digits3(n % 1000), 3);
+#endif
+}
+
+// write the 8 digits of high, then the 8 digits of low (both < 100000000)
+inline void write_digits16(char *dest, uint32_t high, uint32_t low)
+{
+#ifdef SPDLOG_SSE2_DIGITS
+    const __m128i digits = _mm_packus_epi16(digits8_sse2(high), digits8_sse2(low));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dest), _mm_add_epi8(digits, _mm_set1_epi8('0')));
+#else
+    write_digits8(dest, high);
+    write_digits8(dest + 8, low);
+#endif
+}
+
+// write the broken down time as "YYYYMMDD00hhmmss" (16 chars, not 0 terminated).
+// return false (dest left undefined) if the year is not 0-9999 or another field not 0-99.
+inline bool write_tm_digits(char *dest, const std::tm &tm_time)
+{
+    const int year = tm_time.tm_year + 1900;
+    const int month = tm_time.tm_mon + 1;
+    if (year < 0 || year > 9999 || month < 0 || month > 99 || tm_time.tm_mday < 0 || tm_time.tm_mday > 99 || tm_time.tm_hour < 0 ||
+        tm_time.tm_hour > 99 || tm_time.tm_min < 0 || tm_time.tm_min > 99 || tm_time.tm_sec < 0 || tm_time.tm_sec > 99)
+    {
+        return false;
+    }
+    write_digits16(dest, static_cast<uint32_t>(year * 10000 + month * 100 + tm_time.tm_mday),
+        static_cast<uint32_t>(tm_time.tm_hour * 10000 + tm_time.tm_min * 100 + tm_time.tm_sec));
+    return true;
+}
+
 template<typename T>
 inline void pad6(T n, memory_buf_t &dest)
 {
-    pad_uint(n, 6, dest);
+    static_assert(std::is_unsigned<T>::value, "pad6 must get unsigned T");
+    if (n < 1000000)
+    {
+        char digits[8];
+        write_digits8(digits, static_cast<uint32_t>(n));
+        dest.append(digits + 2, digits + 8);
+    }
+    else
+    {
+        append_int(n, dest);
+    }
 }
 
 template<typename T>
 inline void pad9(T n, memory_buf_t &dest)
 {
-    pad_uint(n, 9, dest);
+    static_assert(std::is_unsigned<T>::value, "pad9 must get unsigned T");
+    if (n < 1000000000)
+    {
+        char digits[9];
+        digits[0] = static_cast<char>('0' + n / 100000000);
+        write_digits8(digits + 1, static_cast<uint32_t>(n % 100000000));
+        dest.append(digits, digits + 9);
+    }
+    else
+    {
+        append_int(n, dest);
+    }
 }
 
 // return fraction of a second of the given time_point.
@@ -5,10 +5,16 @@
 
 // multi producer-multi consumer blocking queue.
 // enqueue(..) - will block until room found to put the new message.
-// enqueue_nowait(..) - will return immediately with false if no room left in
-// the queue.
+// enqueue_nowait(..) - will overrun the oldest message in the queue if no room left
+// (optionally reporting it to a callback).
+// try_enqueue(..) - will return immediately with false if the queue already holds the given
+// number of messages.
 // dequeue_for(..) - will block until the queue is not empty or timeout have
 // passed.
+// dequeue_bulk_for(..) - same, then dequeue up to the given count under the same lock.
+// try_dequeue_bulk(..) - dequeue up to the given count without waiting (for spinning consumers).
+// producers notify only when a consumer is actually waiting.
+// visit_unsafe(..) - visit the queued items without locking (crash handlers only).
 
 #include <spdlog/details/circular_q.h>
 
@@ -31,22 +37,79 @@ public:
     // try to enqueue and block if no room left
     void enqueue(T &&item)
     {
+        bool notify;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
             pop_cv_.wait(lock, [this] { return !this->q_.full(); });
             q_.push_back(std::move(item));
+            notify = waiting_consumers_ > 0;
+        }
+        if (notify)
+        {
+            push_cv_.notify_one();
         }
-        push_cv_.notify_one();
     }
 
     // enqueue immediately. overrun oldest message in the queue if no room left.
     void enqueue_nowait(T &&item)
     {
+        enqueue_nowait(std::move(item), [](const T &) {});
+    }
+
+    // same, on_overrun(const T &) is called (under the queue lock) with the overrun message
+    template<typename OnOverrun>
+    void enqueue_nowait(T &&item, OnOverrun &&on_overrun)
+    {
+        bool notify;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            if (q_.full())
+            {
+                on_overrun(q_.front());
+            }
+            q_.push_back(std::move(item));
+            notify = waiting_consumers_ > 0;
+        }
+        if (notify)
+        {
+            push_cv_.notify_one();
+        }
+    }
+
+    // enqueue only if the queue holds less than max_size items. never blocks.
+    bool try_enqueue(T &&item, size_t max_size)
+    {
+        bool notify;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            if (q_.full() || q_.size() >= max_size)
+            {
+                return false;
+            }
+            q_.push_back(std::move(item));
+            notify = waiting_consumers_ > 0;
+        }
+        if (notify)
+        {
+            push_cv_.notify_one();
+        }
+        return true;
+    }
+
+    // enqueue once the queue holds less than max_size items (block until then)
+    void enqueue(T &&item, size_t max_size)
+    {
+        bool notify;
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
+            pop_cv_.wait(lock, [this, max_size] { return !this->q_.full() && this->q_.size() < max_size; });
             q_.push_back(std::move(item));
+            notify = waiting_consumers_ > 0;
+        }
+        if (notify)
+        {
+            push_cv_.notify_one();
         }
-        push_cv_.notify_one();
     }
 
     // try to dequeue item. if no item found. wait up to timeout and try again
@@ -55,7 +118,7 @@ public:
     {
         {
             std::unique_lock<std::mutex> lock(queue_mutex_);
-            if (!push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); }))
+            if (!wait_not_empty_(lock, wait_duration))
             {
                 return false;
             }
@@ -66,6 +129,47 @@ public:
         return true;
     }
 
+    // dequeue up to max_items under a single lock. wait up to timeout if the queue is empty.
+    // Return the number of dequeued items (0 on timeout)
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration)
+    {
+        size_t count = 0;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            if (!wait_not_empty_(lock, wait_duration))
+            {
+                return 0;
+            }
+            while (count < max_items && !q_.empty())
+            {
+                popped_items[count++] = std::move(q_.front());
+                q_.pop_front();
+            }
+        }
+        pop_cv_.notify_all();
+        return count;
+    }
+
+    // dequeue up to max_items under a single lock without waiting.
+    // Return the number of dequeued items (0 if the queue is empty)
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items)
+    {
+        size_t count = 0;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            while (count < max_items && !q_.empty())
+            {
+                popped_items[count++] = std::move(q_.front());
+                q_.pop_front();
+            }
+        }
+        if (count > 0)
+        {
+            pop_cv_.notify_all();
+        }
+        return count;
+    }
+
 #else
     // apparently mingw deadlocks if the mutex is released before cv.notify_one(),
     // so release the mutex at the very end each function.
@@ -76,15 +180,60 @@ public:
         std::unique_lock<std::mutex> lock(queue_mutex_);
         pop_cv_.wait(lock, [this] { return !this->q_.full(); });
         q_.push_back(std::move(item));
-        push_cv_.notify_one();
+        if (waiting_consumers_ > 0)
+        {
+            push_cv_.notify_one();
+        }
     }
 
     // enqueue immediately. overrun oldest message in the queue if no room left.
     void enqueue_nowait(T &&item)
+    {
+        enqueue_nowait(std::move(item), [](const T &) {});
+    }
+
+    // same, on_overrun(const T &) is called (under the queue lock) with the overrun message
+    template<typename OnOverrun>
+    void enqueue_nowait(T &&item, OnOverrun &&on_overrun)
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        if (q_.full())
+        {
+            on_overrun(q_.front());
+        }
+        q_.push_back(std::move(item));
+        if (waiting_consumers_ > 0)
+        {
+            push_cv_.notify_one();
+        }
+    }
+
+    // enqueue only if the queue holds less than max_size items. never blocks.
+    bool try_enqueue(T &&item, size_t max_size)
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
+        if (q_.full() || q_.size() >= max_size)
+        {
+            return false;
+        }
         q_.push_back(std::move(item));
-        push_cv_.notify_one();
+        if (waiting_consumers_ > 0)
+        {
+            push_cv_.notify_one();
+        }
+        return true;
+    }
+
+    // enqueue once the queue holds less than max_size items (block until then)
+    void enqueue(T &&item, size_t max_size)
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        pop_cv_.wait(lock, [this, max_size] { return !this->q_.full() && this->q_.size() < max_size; });
+        q_.push_back(std::move(item));
+        if (waiting_consumers_ > 0)
+        {
+            push_cv_.notify_one();
+        }
     }
 
     // try to dequeue item. if no item found. wait up to timeout and try again
@@ -92,7 +241,7 @@ public:
     bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration)
     {
         std::unique_lock<std::mutex> lock(queue_mutex_);
-        if (!push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); }))
+        if (!wait_not_empty_(lock, wait_duration))
         {
             return false;
         }
@@ -102,6 +251,43 @@ public:
         return true;
     }
 
+    // dequeue up to max_items under a single lock. wait up to timeout if the queue is empty.
+    // Return the number of dequeued items (0 on timeout)
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration)
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        if (!wait_not_empty_(lock, wait_duration))
+        {
+            return 0;
+        }
+        size_t count = 0;
+        while (count < max_items && !q_.empty())
+        {
+            popped_items[count++] = std::move(q_.front());
+            q_.pop_front();
+        }
+        pop_cv_.notify_all();
+        return count;
+    }
+
+    // dequeue up to max_items under a single lock without waiting.
+    // Return the number of dequeued items (0 if the queue is empty)
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items)
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        size_t count = 0;
+        while (count < max_items && !q_.empty())
+        {
+            popped_items[count++] = std::move(q_.front());
+            q_.pop_front();
+        }
+        if (count > 0)
+        {
+            pop_cv_.notify_all();
+        }
+        return count;
+    }
+
 #endif
 
     size_t overrun_counter()
@@ -116,11 +302,32 @@ public:
         return q_.size();
     }
 
+    // visit the queued items, oldest first, without taking the lock: no allocation,
+    // no system call. items may be torn if the queue is used concurrently.
+    template<typename Visitor>
+    void visit_unsafe(Visitor &&visitor) const
+    {
+        for (size_t i = 0, n = q_.size(); i < n; i++)
+        {
+            visitor(q_.at(i));
+        }
+    }
+
 private:
     std::mutex queue_mutex_;
     std::condition_variable push_cv_;
     std::condition_variable pop_cv_;
     spdlog::details::circular_q<T> q_;
+    // consumers blocked in push_cv_ (guarded by queue_mutex_)
+    size_t waiting_consumers_ = 0;
+
+    bool wait_not_empty_(std::unique_lock<std::mutex> &lock, std::chrono::milliseconds wait_duration)
+    {
+        waiting_consumers_++;
+        bool not_empty = push_cv_.wait_for(lock, wait_duration, [this] { return !this->q_.empty(); });
+        waiting_consumers_--;
+        return not_empty;
+    }
 };
 } // namespace details
 } // namespace spdlog
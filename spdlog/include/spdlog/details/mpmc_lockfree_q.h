@@ -0,0 +1,361 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// bounded lock free queue (per slot sequence numbers, see D. Vyukov's bounded mpmc queue).
+// meant to be used with many producers and a single consumer (the thread pool worker),
+// but dequeue is CAS based so producers can evict the oldest item on overrun.
+// the ring is rounded up to a power of two, a count of the items keeps the queue to max_items.
+// enqueue(..) - will spin, then block until room found to put the new message.
+// enqueue_nowait(..) - will overrun the oldest message in the queue if no room left
+// (optionally reporting it to a callback).
+// try_enqueue(.., max_size) - will return false if the queue holds max_size messages.
+// dequeue_for(..) - will spin, then block until the queue is not empty or timeout have
+// passed.
+// dequeue_bulk_for(..) - same, then keep dequeuing (without blocking) up to the given count.
+// try_dequeue_bulk(..) - dequeue up to the given count without waiting (for spinning consumers).
+// producers take the mutex and notify only when a consumer is actually parked.
+// visit_unsafe(..) - visit the published items without dequeuing them (crash handlers only).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace spdlog {
+namespace details {
+
+template<typename T>
+class mpmc_lockfree_queue
+{
+public:
+    using item_type = T;
+
+    explicit mpmc_lockfree_queue(size_t max_items)
+        : max_items_(max_items)
+        , ring_size_(round_up_pow2_(max_items))
+        , mask_(ring_size_ - 1)
+        , cells_(new cell[ring_size_])
+    {
+        for (size_t i = 0; i < ring_size_; i++)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpmc_lockfree_queue(const mpmc_lockfree_queue &) = delete;
+    mpmc_lockfree_queue &operator=(const mpmc_lockfree_queue &) = delete;
+
+    // try to enqueue and block if no room left
+    void enqueue(T &&item)
+    {
+        enqueue(std::move(item), max_items_);
+    }
+
+    // enqueue once the queue holds less than max_size items (block until then)
+    void enqueue(T &&item, size_t max_size)
+    {
+        size_t limit = (std::min)(max_size, max_items_);
+        for (int spins = 0; !try_enqueue(std::move(item), limit); spins++)
+        {
+            if (spins < spin_limit)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            waiting_producers_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            pop_cv_.wait_for(lock, std::chrono::milliseconds(1), [this, limit] { return this->size() < limit; });
+            waiting_producers_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    // enqueue immediately. overrun oldest message in the queue if no room left.
+    void enqueue_nowait(T &&item)
+    {
+        enqueue_nowait(std::move(item), [](const T &) {});
+    }
+
+    // same, on_overrun(const T &) is called with each overrun message
+    template<typename OnOverrun>
+    void enqueue_nowait(T &&item, OnOverrun &&on_overrun)
+    {
+        T discarded;
+        while (!try_enqueue(std::move(item)))
+        {
+            if (try_dequeue(discarded))
+            {
+                overrun_counter_.fetch_add(1, std::memory_order_relaxed);
+                on_overrun(discarded);
+            }
+        }
+    }
+
+    // enqueue only if the queue holds less than max_size items. never blocks.
+    bool try_enqueue(T &&item, size_t max_size)
+    {
+        // take a place first: the ring may have more cells than max_items_
+        size_t limit = (std::min)(max_size, max_items_);
+        size_t count = count_.load(std::memory_order_relaxed);
+        do
+        {
+            if (count >= limit)
+            {
+                return false;
+            }
+        } while (!count_.compare_exchange_weak(count, count + 1, std::memory_order_relaxed));
+
+        if (!try_enqueue_(std::move(item)))
+        {
+            // a consumer is still moving out of the cell
+            count_.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // try to enqueue without blocking. return false if the queue is full.
+    bool try_enqueue(T &&item)
+    {
+        return try_enqueue(std::move(item), max_items_);
+    }
+
+    // try to dequeue without blocking. return false if the queue is empty.
+    bool try_dequeue(T &popped_item)
+    {
+        if (!try_dequeue_(popped_item))
+        {
+            return false;
+        }
+        release_(1);
+        return true;
+    }
+
+    // try to dequeue item. if no item found. spin, then wait up to timeout and try again
+    // Return true, if succeeded dequeue item, false otherwise
+    bool dequeue_for(T &popped_item, std::chrono::milliseconds wait_duration)
+    {
+        for (int spins = 0; spins < spin_limit; spins++)
+        {
+            if (try_dequeue(popped_item))
+            {
+                return true;
+            }
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            waiting_consumers_.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            push_cv_.wait_for(lock, wait_duration, [this] { return !this->empty(); });
+            waiting_consumers_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return try_dequeue(popped_item);
+    }
+
+    // dequeue up to max_items, waiting up to timeout for the first one.
+    // Return the number of dequeued items (0 on timeout)
+    size_t dequeue_bulk_for(T *popped_items, size_t max_items, std::chrono::milliseconds wait_duration)
+    {
+        if (max_items == 0 || !dequeue_for(popped_items[0], wait_duration))
+        {
+            return 0;
+        }
+        size_t count = 1;
+        while (count < max_items && try_dequeue_(popped_items[count]))
+        {
+            count++;
+        }
+        if (count > 1)
+        {
+            release_(count - 1);
+        }
+        return count;
+    }
+
+    // dequeue up to max_items without waiting.
+    // Return the number of dequeued items (0 if the queue is empty)
+    size_t try_dequeue_bulk(T *popped_items, size_t max_items)
+    {
+        size_t count = 0;
+        while (count < max_items && try_dequeue_(popped_items[count]))
+        {
+            count++;
+        }
+        if (count > 0)
+        {
+            release_(count);
+        }
+        return count;
+    }
+
+    size_t overrun_counter()
+    {
+        return overrun_counter_.load(std::memory_order_relaxed);
+    }
+
+    // approximate number of items in the queue (counts the items being enqueued or dequeued)
+    size_t size()
+    {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    // max_items, not the rounded up ring size
+    size_t capacity() const
+    {
+        return max_items_;
+    }
+
+    // visit the published items, oldest first: no allocation, no system call.
+    // items may be torn if they are dequeued concurrently.
+    template<typename Visitor>
+    void visit_unsafe(Visitor &&visitor) const
+    {
+        size_t tail = enqueue_pos_.load(std::memory_order_acquire);
+        for (size_t pos = dequeue_pos_.load(std::memory_order_acquire); pos < tail; pos++)
+        {
+            const cell &c = cells_[pos & mask_];
+            if (c.sequence.load(std::memory_order_acquire) == pos + 1)
+            {
+                visitor(c.data);
+            }
+        }
+    }
+
+private:
+    static const int spin_limit = 64;
+    static const size_t cache_line_size = 64;
+
+    struct cell
+    {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    bool empty()
+    {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        return cells_[pos & mask_].sequence.load(std::memory_order_acquire) != pos + 1;
+    }
+
+    // claim the next cell, return false if it is still in use
+    bool try_enqueue_(T &&item)
+    {
+        cell *c;
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            c = &cells_[pos & mask_];
+            size_t seq = c->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0)
+            {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        c->data = std::move(item);
+        c->sequence.store(pos + 1, std::memory_order_release);
+
+        // wake the consumer only if it is parked
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_consumers_.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            push_cv_.notify_one();
+        }
+        return true;
+    }
+
+    // claim the oldest published cell, return false if there is none
+    bool try_dequeue_(T &popped_item)
+    {
+        cell *c;
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            c = &cells_[pos & mask_];
+            size_t seq = c->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        popped_item = std::move(c->data);
+        c->sequence.store(pos + ring_size_, std::memory_order_release);
+        return true;
+    }
+
+    // give back the places of dequeued items and wake blocked producers only if there are any
+    void release_(size_t count)
+    {
+        count_.fetch_sub(count, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_producers_.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pop_cv_.notify_all();
+        }
+    }
+
+    static size_t round_up_pow2_(size_t n)
+    {
+        size_t result = 2;
+        while (result < n)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t max_items_;
+    const size_t ring_size_;
+    const size_t mask_;
+    std::unique_ptr<cell[]> cells_;
+
+    // producers and consumer positions live on separate cache lines
+    char pad0_[cache_line_size];
+    std::atomic<size_t> enqueue_pos_{0};
+    char pad1_[cache_line_size - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> dequeue_pos_{0};
+    char pad2_[cache_line_size - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> count_{0};
+    char pad3_[cache_line_size - sizeof(std::atomic<size_t>)];
+
+    std::atomic<size_t> overrun_counter_{0};
+    std::atomic<size_t> waiting_consumers_{0};
+    std::atomic<size_t> waiting_producers_{0};
+    std::mutex mutex_;
+    std::condition_variable push_cv_;
+    std::condition_variable pop_cv_;
+};
+} // namespace details
+} // namespace spdlog
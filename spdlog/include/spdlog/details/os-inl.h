@@ -10,6 +10,7 @@
 #include <spdlog/common.h>
 
 #include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
@@ -21,6 +22,10 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#    include <immintrin.h> // _mm_pause
+#endif
+
 #ifdef _WIN32
 
 #    include <io.h>      // _get_osfhandle and _isatty support
@@ -44,6 +49,9 @@
 
 #    ifdef __linux__
 #        include <sys/syscall.h> //Use gettid() syscall under linux to get thread id
+#        include <sys/resource.h> // setpriority
+#        include <pthread.h>      // pthread_setname_np, pthread_setaffinity_np
+#        include <sched.h>        // SCHED_IDLE
 
 #    elif defined(_AIX)
 #        include <pthread.h> // for pthread_getthrds_np
@@ -205,6 +213,71 @@ SPDLOG_INLINE bool path_exists(const filename_t &filename) SPDLOG_NOEXCEPT
 #    pragma warning(disable : 4702)
 #endif
 
+SPDLOG_INLINE bool fsync(FILE *f) SPDLOG_NOEXCEPT
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+    return ::_commit(::_fileno(f)) == 0;
+#else
+    return ::fsync(fileno(f)) == 0;
+#endif
+}
+
+SPDLOG_INLINE bool write_fd(int fd, const char *data, size_t size) SPDLOG_NOEXCEPT
+{
+    while (size > 0)
+    {
+#if defined(_WIN32) && !defined(__CYGWIN__)
+        int written = ::_write(fd, data, static_cast<unsigned int>(size));
+#else
+        ssize_t written = ::write(fd, data, size);
+#endif
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+SPDLOG_INLINE int fileno_unsafe(FILE *f) SPDLOG_NOEXCEPT
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+    return ::_fileno(f);
+#elif defined(__GLIBC__)
+    return ::fileno_unlocked(f);
+#else
+    return fileno(f);
+#endif
+}
+
+SPDLOG_INLINE bool flush_stdio_unsafe(FILE *f) SPDLOG_NOEXCEPT
+{
+#if defined(__GLIBC__)
+    // glibc exposes the stream buffer pointers in struct _IO_FILE
+    char *base = f->_IO_write_base;
+    char *ptr = f->_IO_write_ptr;
+    if (base == nullptr || ptr <= base)
+    {
+        return true;
+    }
+    if (!write_fd(::fileno_unlocked(f), base, static_cast<size_t>(ptr - base)))
+    {
+        return false;
+    }
+    f->_IO_write_ptr = base;
+    return true;
+#else
+    (void)f;
+    return false;
+#endif
+}
+
 // Return file size according to open FILE* object
 SPDLOG_INLINE size_t filesize(FILE *f)
 {
@@ -382,6 +455,74 @@ SPDLOG_INLINE void sleep_for_millis(unsigned int milliseconds) SPDLOG_NOEXCEPT
 #endif
 }
 
+SPDLOG_INLINE void cpu_relax() SPDLOG_NOEXCEPT
+{
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+SPDLOG_INLINE bool set_thread_name(const std::string &name) SPDLOG_NOEXCEPT
+{
+#if defined(__linux__)
+    // linux limits thread names to 16 bytes (including the null terminator)
+    char truncated[16];
+    size_t size = (std::min)(name.size(), sizeof(truncated) - 1);
+    std::memcpy(truncated, name.data(), size);
+    truncated[size] = '\0';
+    return ::pthread_setname_np(::pthread_self(), truncated) == 0;
+#elif defined(__APPLE__)
+    return ::pthread_setname_np(name.c_str()) == 0;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+SPDLOG_INLINE bool set_thread_affinity(const std::vector<int> &cpus) SPDLOG_NOEXCEPT
+{
+#if defined(__linux__)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int cpu : cpus)
+    {
+        if (cpu < 0 || cpu >= CPU_SETSIZE)
+        {
+            return false;
+        }
+        CPU_SET(cpu, &cpu_set);
+    }
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+SPDLOG_INLINE bool set_thread_nice(int nice_value) SPDLOG_NOEXCEPT
+{
+#if defined(__linux__)
+    // on linux the nice value is per thread (PRIO_PROCESS with a thread id)
+    return ::setpriority(PRIO_PROCESS, static_cast<id_t>(_thread_id()), nice_value) == 0;
+#else
+    (void)nice_value;
+    return false;
+#endif
+}
+
+SPDLOG_INLINE bool set_thread_sched_idle() SPDLOG_NOEXCEPT
+{
+#if defined(__linux__) && defined(SCHED_IDLE)
+    struct sched_param param;
+    param.sched_priority = 0;
+    return ::pthread_setschedparam(::pthread_self(), SCHED_IDLE, &param) == 0;
+#else
+    return false;
+#endif
+}
+
 // wchar support for windows file names (SPDLOG_WCHAR_FILENAMES must be defined)
 #if defined(_WIN32) && defined(SPDLOG_WCHAR_FILENAMES)
 SPDLOG_INLINE std::string filename_to_str(const filename_t &filename)
@@ -5,6 +5,7 @@
 
 #include <spdlog/common.h>
 #include <ctime> // std::time_t
+#include <vector>
 
 namespace spdlog {
 namespace details {
@@ -61,6 +62,22 @@ SPDLOG_API bool path_exists(const filename_t &filename) SPDLOG_NOEXCEPT;
 // Return file size according to open FILE* object
 SPDLOG_API size_t filesize(FILE *f);
 
+// Ask the OS to write the (already flushed) data of the file to the storage device.
+// Return false on failure.
+SPDLOG_API bool fsync(FILE *f) SPDLOG_NOEXCEPT;
+
+// Async-signal-safe helpers for crash handlers (no lock, no allocation).
+
+// Write the whole buffer to the file descriptor with write(2), retrying on EINTR.
+SPDLOG_API bool write_fd(int fd, const char *data, size_t size) SPDLOG_NOEXCEPT;
+
+// The file descriptor of the stdio stream, read without taking the stream lock.
+SPDLOG_API int fileno_unsafe(FILE *f) SPDLOG_NOEXCEPT;
+
+// Write the output still buffered in the stdio stream with write(2) and mark it written
+// (fflush is not async-signal-safe). glibc only: return false if not supported or failed.
+SPDLOG_API bool flush_stdio_unsafe(FILE *f) SPDLOG_NOEXCEPT;
+
 // Return utc offset in minutes or throw spdlog_ex on failure
 SPDLOG_API int utc_minutes_offset(const std::tm &tm = details::os::localtime());
 
@@ -76,6 +93,24 @@ SPDLOG_API size_t thread_id() SPDLOG_NOEXCEPT;
 // See https://github.com/gabime/spdlog/issues/609
 SPDLOG_API void sleep_for_millis(unsigned int milliseconds) SPDLOG_NOEXCEPT;
 
+// Hint the cpu that the caller is spinning (pause/yield instruction, no system call)
+SPDLOG_API void cpu_relax() SPDLOG_NOEXCEPT;
+
+// Calling thread attributes (best effort).
+// Return false if failed or not supported on this platform.
+
+// Set the name of the calling thread (truncated to 15 chars on linux)
+SPDLOG_API bool set_thread_name(const std::string &name) SPDLOG_NOEXCEPT;
+
+// Restrict the calling thread to the given cpus (linux only)
+SPDLOG_API bool set_thread_affinity(const std::vector<int> &cpus) SPDLOG_NOEXCEPT;
+
+// Set the nice value of the calling thread (linux only)
+SPDLOG_API bool set_thread_nice(int nice_value) SPDLOG_NOEXCEPT;
+
+// Run the calling thread with the SCHED_IDLE policy (linux only)
+SPDLOG_API bool set_thread_sched_idle() SPDLOG_NOEXCEPT;
+
 SPDLOG_API std::string filename_to_str(const filename_t &filename);
 
 SPDLOG_API int pid() SPDLOG_NOEXCEPT;
@@ -0,0 +1,138 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// bounded wait free single producer-single consumer ring of max_items items
+// (stored in a power of 2 sized array).
+// the producer owns tail_, the consumer owns head_, each side only reads the
+// other's index, so a push or a pop never waits on the other side.
+// try_enqueue(..) - return false if no room left.
+// front() / pop_front() - consumer side peek and pop, used to merge several rings.
+
+#include <atomic>
+#include <memory>
+
+namespace spdlog {
+namespace details {
+
+template<typename T>
+class spsc_ring_queue
+{
+public:
+    using item_type = T;
+
+    explicit spsc_ring_queue(size_t max_items)
+        : capacity_(max_items)
+        , mask_(round_up_pow2_(max_items) - 1)
+        , v_(new T[mask_ + 1])
+    {}
+
+    spsc_ring_queue(const spsc_ring_queue &) = delete;
+    spsc_ring_queue &operator=(const spsc_ring_queue &) = delete;
+
+    // producer side
+    bool try_enqueue(T &&item)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ >= capacity_)
+        {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ >= capacity_)
+            {
+                return false;
+            }
+        }
+        v_[tail & mask_] = std::move(item);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side. return nullptr if empty.
+    T *front()
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_)
+        {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_)
+            {
+                return nullptr;
+            }
+        }
+        return &v_[head & mask_];
+    }
+
+    // consumer side. only valid after front() returned non null.
+    void pop_front()
+    {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool try_dequeue(T &popped_item)
+    {
+        T *item = front();
+        if (item == nullptr)
+        {
+            return false;
+        }
+        popped_item = std::move(*item);
+        pop_front();
+        return true;
+    }
+
+    bool empty() const
+    {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    size_t size() const
+    {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    // visit the queued items, oldest first, from any thread: no allocation, no system call.
+    // items may be torn if they are popped concurrently (crash handlers only).
+    template<typename Visitor>
+    void visit_unsafe(Visitor &&visitor) const
+    {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        for (size_t pos = head_.load(std::memory_order_acquire); pos < tail; pos++)
+        {
+            visitor(v_[pos & mask_]);
+        }
+    }
+
+private:
+    static const size_t cache_line_size = 64;
+
+    static size_t round_up_pow2_(size_t n)
+    {
+        size_t result = 2;
+        while (result < n)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<T[]> v_;
+
+    // producer and consumer indexes (and their cached copy of the other side) live on separate cache lines
+    char pad0_[cache_line_size];
+    std::atomic<size_t> tail_{0};
+    size_t head_cache_{0};
+    char pad1_[cache_line_size - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+    std::atomic<size_t> head_{0};
+    size_t tail_cache_{0};
+    char pad2_[cache_line_size - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+};
+} // namespace details
+} // namespace spdlog
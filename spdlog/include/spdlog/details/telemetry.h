@@ -0,0 +1,203 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+// Counters and latency histograms for the async thread pool and the sinks.
+// All counters are relaxed atomics: they can be read from any thread while logging,
+// a snapshot is consistent per counter but not across counters.
+
+#include <spdlog/common.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace spdlog {
+namespace details {
+
+// percentiles of a latency_histogram (nanoseconds, upper bound of the matching bucket)
+struct latency_summary
+{
+    uint64_t count = 0;
+    uint64_t mean_ns = 0;
+    uint64_t p50_ns = 0;
+    uint64_t p90_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+// log-linear (HDR style) histogram: each power of 2 is split in 8 linear sub buckets,
+// so any recorded value is known within 12.5%. values from 0 to ~2^47 ns (~39 hours).
+class latency_histogram
+{
+public:
+    latency_histogram()
+    {
+        for (auto &bucket : buckets_)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    latency_histogram(const latency_histogram &) = delete;
+    latency_histogram &operator=(const latency_histogram &) = delete;
+
+    void record(uint64_t ns)
+    {
+        buckets_[bucket_index_(ns)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (ns > max && !max_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {}
+    }
+
+    void record(std::chrono::nanoseconds duration)
+    {
+        record(duration.count() > 0 ? static_cast<uint64_t>(duration.count()) : 0);
+    }
+
+    latency_summary summary() const
+    {
+        latency_summary result;
+        uint64_t counts[bucket_count];
+        for (size_t i = 0; i < bucket_count; i++)
+        {
+            counts[i] = buckets_[i].load(std::memory_order_relaxed);
+            result.count += counts[i];
+        }
+        if (result.count == 0)
+        {
+            return result;
+        }
+        result.mean_ns = sum_.load(std::memory_order_relaxed) / result.count;
+        result.max_ns = max_.load(std::memory_order_relaxed);
+
+        const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+        uint64_t *targets[] = {&result.p50_ns, &result.p90_ns, &result.p99_ns, &result.p999_ns};
+        uint64_t seen = 0;
+        size_t q = 0;
+        for (size_t i = 0; i < bucket_count && q < 4; i++)
+        {
+            seen += counts[i];
+            while (q < 4 && static_cast<double>(seen) >= quantiles[q] * static_cast<double>(result.count))
+            {
+                *targets[q] = bucket_upper_bound_(i) < result.max_ns ? bucket_upper_bound_(i) : result.max_ns;
+                q++;
+            }
+        }
+        return result;
+    }
+
+private:
+    static const size_t sub_bucket_bits = 3;
+    static const size_t sub_buckets = size_t(1) << sub_bucket_bits;
+    static const size_t magnitudes = 45;
+    static const size_t bucket_count = (magnitudes + 1) * sub_buckets;
+
+    static unsigned msb_(uint64_t value)
+    {
+        unsigned result = 0;
+        for (unsigned shift = 32; shift != 0; shift >>= 1)
+        {
+            if (value >> shift)
+            {
+                value >>= shift;
+                result += shift;
+            }
+        }
+        return result;
+    }
+
+    static size_t bucket_index_(uint64_t ns)
+    {
+        if (ns < sub_buckets)
+        {
+            return static_cast<size_t>(ns);
+        }
+        size_t shift = msb_(ns) - sub_bucket_bits;
+        size_t index = (shift + 1) * sub_buckets + static_cast<size_t>((ns >> shift) & (sub_buckets - 1));
+        return index < bucket_count ? index : bucket_count - 1;
+    }
+
+    static uint64_t bucket_upper_bound_(size_t index)
+    {
+        if (index < sub_buckets)
+        {
+            return index;
+        }
+        size_t shift = index / sub_buckets - 1;
+        uint64_t lower = static_cast<uint64_t>(sub_buckets + index % sub_buckets) << shift;
+        return lower + (uint64_t(1) << shift) - 1;
+    }
+
+    std::atomic<uint64_t> buckets_[bucket_count];
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// snapshot of a sink's counters
+struct sink_stats
+{
+    uint64_t bytes_written = 0;
+    // write calls issued to the underlying file or stream (one per message or per batch)
+    uint64_t writes = 0;
+    uint64_t flushes = 0;
+    uint64_t flush_time_total_ns = 0;
+    uint64_t flush_time_max_ns = 0;
+};
+
+// counters updated by a sink while holding its own mutex (single writer), read from any thread
+class sink_counters
+{
+public:
+    void on_write(size_t bytes)
+    {
+        add_(bytes_written_, bytes);
+        add_(writes_, 1);
+    }
+
+    // time the given flush function
+    template<typename Flush>
+    void timed_flush(Flush &&flush)
+    {
+        auto start = std::chrono::steady_clock::now();
+        flush();
+        auto ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        add_(flushes_, 1);
+        add_(flush_time_total_ns_, ns);
+        if (ns > flush_time_max_ns_.load(std::memory_order_relaxed))
+        {
+            flush_time_max_ns_.store(ns, std::memory_order_relaxed);
+        }
+    }
+
+    sink_stats snapshot() const
+    {
+        sink_stats result;
+        result.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+        result.writes = writes_.load(std::memory_order_relaxed);
+        result.flushes = flushes_.load(std::memory_order_relaxed);
+        result.flush_time_total_ns = flush_time_total_ns_.load(std::memory_order_relaxed);
+        result.flush_time_max_ns = flush_time_max_ns_.load(std::memory_order_relaxed);
+        return result;
+    }
+
+private:
+    // no read-modify-write needed with a single writer
+    static void add_(std::atomic<uint64_t> &counter, uint64_t value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> bytes_written_{0};
+    std::atomic<uint64_t> writes_{0};
+    std::atomic<uint64_t> flushes_{0};
+    std::atomic<uint64_t> flush_time_total_ns_{0};
+    std::atomic<uint64_t> flush_time_max_ns_{0};
+};
+
+} // namespace details
+} // namespace spdlog
@@ -9,33 +9,117 @@
 
 #include <spdlog/common.h>
 #include <cassert>
+#include <cstdio>
+#include <limits>
 
 namespace spdlog {
 namespace details {
 
-SPDLOG_INLINE thread_pool::thread_pool(
-    size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start, std::function<void()> on_thread_stop)
-    : q_(q_max_items)
+SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n, const thread_pool_options &options,
+    std::function<void()> on_thread_start, std::function<void()> on_thread_stop)
+    : queue_type_(options.queue_type)
+    , batch_size_(options.batch_size)
+    , wait_strategy_(options.wait_strategy)
+    , spin_count_(options.spin_count)
+    , yield_count_(options.yield_count)
+    , sharding_(options.sharding)
+    , q_max_items_(q_max_items)
+    , priority_level_(options.priority_level)
+    , reserved_items_(options.reserved_items)
+    , report_drops_(options.report_drops)
+    , telemetry_(options.telemetry)
 {
     if (threads_n == 0 || threads_n > 1000)
     {
         throw_spdlog_ex("spdlog::thread_pool(): invalid threads_n param (valid "
                         "range is 1-1000)");
     }
+    if (batch_size_ == 0)
+    {
+        throw_spdlog_ex("spdlog::thread_pool(): invalid batch_size option (must be > 0)");
+    }
+    if (reserved_items_ >= q_max_items)
+    {
+        throw_spdlog_ex("spdlog::thread_pool(): invalid reserved_items option (must be < q_max_items)");
+    }
+    for (auto &counter : dropped_counters_)
+    {
+        counter.store(0, std::memory_order_relaxed);
+    }
+    size_t shards_n = sharding_ != async_sharding::none ? threads_n : 1;
+    if (queue_type_ == async_queue_type::blocking)
+    {
+        for (size_t i = 0; i < shards_n; i++)
+        {
+            qs_.push_back(details::make_unique<q_type>(q_max_items));
+        }
+        arena_ = details::make_unique<byte_arena>(options.arena_size != 0 ? options.arena_size : q_max_items * 128 * shards_n);
+    }
+    else if (queue_type_ == async_queue_type::lockfree)
+    {
+        for (size_t i = 0; i < shards_n; i++)
+        {
+            lockfree_qs_.push_back(details::make_unique<lockfree_q_type>(q_max_items));
+        }
+    }
+    else if (queue_type_ == async_queue_type::per_thread)
+    {
+#ifdef SPDLOG_NO_TLS
+        throw_spdlog_ex("spdlog::thread_pool(): per_thread queue requires thread local storage (SPDLOG_NO_TLS is defined)");
+#endif
+        if (threads_n != 1)
+        {
+            throw_spdlog_ex("spdlog::thread_pool(): per_thread queue supports exactly 1 worker thread");
+        }
+        static std::atomic<size_t> s_next_pool_id{1};
+        pool_id_ = s_next_pool_id.fetch_add(1, std::memory_order_relaxed);
+        ring_max_items_ = q_max_items;
+        ring_arena_size_ = options.arena_size != 0 ? options.arena_size : q_max_items * 128;
+    }
+    running_workers_.reset(new std::atomic<size_t>[shards_n]);
+    drops_pending_.resize(shards_n);
+    any_drops_pending_.reset(new std::atomic<bool>[shards_n]);
+    for (size_t shard = 0; shard < shards_n; shard++)
+    {
+        running_workers_[shard].store(0, std::memory_order_relaxed);
+        any_drops_pending_[shard].store(false, std::memory_order_relaxed);
+    }
     for (size_t i = 0; i < threads_n; i++)
     {
-        threads_.emplace_back([this, on_thread_start, on_thread_stop] {
+        size_t shard = i % shards_n;
+        running_workers_[shard].fetch_add(1, std::memory_order_relaxed);
+        threads_.emplace_back([this, i, shard, options, on_thread_start, on_thread_stop] {
+            setup_worker_(options, i);
             on_thread_start();
-            this->thread_pool::worker_loop_();
+            this->thread_pool::worker_loop_(shard);
             on_thread_stop();
+            worker_stopped_(shard);
         });
     }
 }
 
+SPDLOG_INLINE thread_pool::thread_pool(
+    size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start, std::function<void()> on_thread_stop)
+    : thread_pool(q_max_items, threads_n, thread_pool_options(), on_thread_start, on_thread_stop)
+{}
+
 SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start)
     : thread_pool(q_max_items, threads_n, on_thread_start, [] {})
 {}
 
+SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n, const thread_pool_options &options)
+    : thread_pool(
+          q_max_items, threads_n, options, [] {}, [] {})
+{}
+
+SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n, async_queue_type queue_type)
+    : thread_pool(q_max_items, threads_n, [queue_type] {
+        thread_pool_options options;
+        options.queue_type = queue_type;
+        return options;
+    }())
+{}
+
 SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n)
     : thread_pool(
           q_max_items, threads_n, [] {}, [] {})
@@ -45,92 +129,880 @@ SPDLOG_INLINE thread_pool::thread_pool(size_t q_max_items, size_t threads_n)
 SPDLOG_INLINE thread_pool::~thread_pool()
 {
     SPDLOG_TRY
+    {
+        join_workers_();
+    }
+    SPDLOG_CATCH_STD
+}
+
+void SPDLOG_INLINE thread_pool::join_workers_()
+{
+    if (queue_type_ == async_queue_type::per_thread || terminating_.load(std::memory_order_acquire))
+    {
+        // no ring for the destroying thread (its thread locals may already be gone at exit),
+        // the worker drains all rings and quits once they are empty.
+        // shut down pools: the workers left running are done with their sink soon
+        terminating_.store(true, std::memory_order_release);
+        stop_workers_((std::chrono::steady_clock::time_point::max)());
+    }
+    else
     {
         for (size_t i = 0; i < threads_.size(); i++)
         {
-            post_async_msg_(async_msg(async_msg_type::terminate), async_overflow_policy::block);
+            post_async_msg_(async_msg(async_msg_type::terminate), async_overflow_policy::block, i % shards_count());
+        }
+    }
+
+    for (auto &t : threads_)
+    {
+        t.join();
+    }
+    threads_.clear();
+}
+
+size_t SPDLOG_INLINE thread_pool::shutdown(std::chrono::milliseconds timeout)
+{
+    if (threads_.empty() || terminating_.load(std::memory_order_acquire))
+    {
+        return 0;
+    }
+    size_t dropped_before = dropped_counter();
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    accepting_.store(false, std::memory_order_seq_cst);
+
+    while (queue_size() > 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (queue_size() > 0)
+    {
+        discarding_.store(true, std::memory_order_relaxed);
+    }
+    // the workers discard what is left and quit, unless one is stuck in a sink.
+    // the last one to quit drops the messages of producers that were already past the
+    // admission check (see worker_stopped_())
+    terminating_.store(true, std::memory_order_release);
+    const auto grace = std::chrono::milliseconds(100);
+    if (!stop_workers_((std::max)(deadline, std::chrono::steady_clock::now()) + grace))
+    {
+        return dropped_counter() - dropped_before;
+    }
+    for (auto &t : threads_)
+    {
+        t.join();
+    }
+    threads_.clear();
+    return dropped_counter() - dropped_before;
+}
+
+bool SPDLOG_INLINE thread_pool::stop_workers_(std::chrono::steady_clock::time_point deadline)
+{
+    for (;;)
+    {
+        bool running = false;
+        for (size_t shard = 0; shard < shards_count(); shard++)
+        {
+            if (running_workers_[shard].load(std::memory_order_acquire) == 0)
+            {
+                continue;
+            }
+            running = true;
+            if (queue_type_ == async_queue_type::per_thread)
+            {
+                wake_parked_worker_();
+            }
+            else if (shard_queue_size_(shard) == 0)
+            {
+                // wake up a sleeping worker, never wait for room in the queue
+                post_async_msg_(async_msg(async_msg_type::terminate), async_overflow_policy::discard_new, shard);
+            }
         }
+        if (!running)
+        {
+            return true;
+        }
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
 
-        for (auto &t : threads_)
+// a worker left a shut down pool stuck in a sink (see shutdown()): the last one to quit drops
+// what the producers queued meanwhile, the producers drop the rest themselves
+void SPDLOG_INLINE thread_pool::worker_stopped_(size_t shard)
+{
+    running_workers_[shard].fetch_sub(1, std::memory_order_acq_rel);
+    if (!terminating_.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    for (size_t i = 0; i < shards_count(); i++)
+    {
+        if (running_workers_[i].load(std::memory_order_acquire) != 0)
         {
-            t.join();
+            return;
+        }
+    }
+    stopped_.store(true, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    drain_stopped_();
+}
+
+void SPDLOG_INLINE thread_pool::drain_stopped_()
+{
+    std::lock_guard<std::mutex> lock(stopped_mutex_);
+    std::vector<async_msg> leftovers(batch_size_);
+    for (size_t shard = 0; shard < shards_count(); shard++)
+    {
+        size_t count;
+        while ((count = try_dequeue_bulk_(shard, leftovers.data(), leftovers.size())) > 0)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                count_dropped_(leftovers[i], shard);
+                leftovers[i].release();
+            }
         }
     }
-    SPDLOG_CATCH_STD
 }
 
-void SPDLOG_INLINE thread_pool::post_log(async_logger_ptr &&worker_ptr, const details::log_msg &msg, async_overflow_policy overflow_policy)
+size_t SPDLOG_INLINE thread_pool::shard_queue_size_(size_t shard)
 {
-    async_msg async_m(std::move(worker_ptr), async_msg_type::log, msg);
-    post_async_msg_(std::move(async_m), overflow_policy);
+    if (queue_type_ == async_queue_type::per_thread)
+    {
+        return queue_size();
+    }
+    if (queue_type_ == async_queue_type::lockfree)
+    {
+        return lockfree_qs_[shard]->size();
+    }
+    return qs_[shard]->size();
 }
 
-void SPDLOG_INLINE thread_pool::post_flush(async_logger_ptr &&worker_ptr, async_overflow_policy overflow_policy)
+void SPDLOG_INLINE thread_pool::post_log(async_logger_ptr &&worker_ptr, const details::log_msg &msg, async_overflow_policy overflow_policy,
+    deferred_format_fn format_fn, size_t shard)
 {
-    post_async_msg_(async_msg(std::move(worker_ptr), async_msg_type::flush), overflow_policy);
+    byte_arena *arena = queue_type_ == async_queue_type::per_thread ? &thread_ring_().arena : arena_.get();
+    async_msg async_m(std::move(worker_ptr), async_msg_type::log, msg, arena, format_fn);
+    if (!async_m.in_arena())
+    {
+        heap_payloads_.fetch_add(1, std::memory_order_relaxed);
+    }
+    post_async_msg_(std::move(async_m), overflow_policy, shard);
+}
+
+void SPDLOG_INLINE thread_pool::post_flush(async_logger_ptr &&worker_ptr, async_overflow_policy overflow_policy, size_t shard)
+{
+    post_async_msg_(async_msg(std::move(worker_ptr), async_msg_type::flush), overflow_policy, shard);
 }
 
 size_t SPDLOG_INLINE thread_pool::overrun_counter()
 {
-    return q_.overrun_counter();
+    size_t total = 0;
+    if (queue_type_ == async_queue_type::per_thread)
+    {
+        return rings_overrun_counter_.load(std::memory_order_relaxed);
+    }
+    for (auto &q : lockfree_qs_)
+    {
+        total += q->overrun_counter();
+    }
+    for (auto &q : qs_)
+    {
+        total += q->overrun_counter();
+    }
+    return total;
 }
 
 size_t SPDLOG_INLINE thread_pool::queue_size()
 {
-    return q_.size();
+    if (queue_type_ == async_queue_type::per_thread)
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        size_t total = 0;
+        for (auto &ring : rings_)
+        {
+            total += ring->queue.size();
+        }
+        return total;
+    }
+    size_t total = 0;
+    for (auto &q : lockfree_qs_)
+    {
+        total += q->size();
+    }
+    for (auto &q : qs_)
+    {
+        total += q->size();
+    }
+    return total;
 }
 
-void SPDLOG_INLINE thread_pool::post_async_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy)
+size_t SPDLOG_INLINE thread_pool::dropped_counter(level::level_enum lvl) const
+{
+    return dropped_counters_[lvl].load(std::memory_order_relaxed);
+}
+
+size_t SPDLOG_INLINE thread_pool::dropped_counter() const
+{
+    size_t total = 0;
+    for (auto &counter : dropped_counters_)
+    {
+        total += counter.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+thread_pool_stats SPDLOG_INLINE thread_pool::stats()
+{
+    thread_pool_stats result;
+    result.dequeued = dequeued_counter_.load(std::memory_order_relaxed);
+    result.queue_depth = queue_size();
+    result.queue_high_water = (std::max)(queue_high_water_.load(std::memory_order_relaxed), telemetry_ ? result.queue_depth : 0);
+    result.overrun = overrun_counter();
+    for (size_t i = 0; i < level::n_levels; i++)
+    {
+        result.dropped_per_level[i] = dropped_counter(static_cast<level::level_enum>(i));
+        result.dropped += result.dropped_per_level[i];
+    }
+    if (telemetry_)
+    {
+        result.enqueued = result.dequeued + result.queue_depth + result.overrun;
+    }
+    result.latency = latency_.summary();
+    result.heap_payloads = heap_payloads_.load(std::memory_order_relaxed);
+    return result;
+}
+
+void SPDLOG_INLINE thread_pool::visit_queued_unsafe(crash_visitor visitor, void *ctx) const
+{
+    auto visit = [visitor, ctx](const async_msg &msg) {
+        if (msg.msg_type == async_msg_type::log && msg.format_fn == nullptr)
+        {
+            visitor(msg, ctx);
+        }
+    };
+    for (auto &q : qs_)
+    {
+        q->visit_unsafe(visit);
+    }
+    for (auto &q : lockfree_qs_)
+    {
+        q->visit_unsafe(visit);
+    }
+    for (auto &ring : rings_)
+    {
+        ring->queue.visit_unsafe(visit);
+    }
+}
+
+bool SPDLOG_INLINE thread_pool::freeze_unsafe(std::chrono::milliseconds timeout)
+{
+    frozen_.store(true, std::memory_order_seq_cst);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (busy_workers_.load(std::memory_order_seq_cst) != 0)
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// a crash handler is writing the queued messages: never take another one
+void SPDLOG_INLINE thread_pool::park_frozen_()
+{
+    for (;;)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
+
+async_queue_type SPDLOG_INLINE thread_pool::queue_type() const
+{
+    return queue_type_;
+}
+
+async_sharding SPDLOG_INLINE thread_pool::sharding() const
+{
+    return sharding_;
+}
+
+size_t SPDLOG_INLINE thread_pool::shards_count() const
+{
+    return queue_type_ == async_queue_type::per_thread ? 1 : qs_.size() + lockfree_qs_.size();
+}
+
+size_t SPDLOG_INLINE thread_pool::assign_shard(const void *key)
+{
+    if (shards_count() == 1)
+    {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(shards_mutex_);
+    for (auto &assigned : assigned_shards_)
+    {
+        if (assigned.first == key)
+        {
+            return assigned.second;
+        }
+    }
+    size_t shard = next_shard_;
+    next_shard_ = (next_shard_ + 1) % shards_count();
+    assigned_shards_.emplace_back(key, shard);
+    return shard;
+}
+
+void SPDLOG_INLINE thread_pool::post_async_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy, size_t shard)
+{
+    // shut down: nothing would dequeue the message (only the terminate messages are let through)
+    bool terminate = new_msg.msg_type == async_msg_type::terminate;
+    if (!terminate && !accepting_.load(std::memory_order_acquire))
+    {
+        count_dropped_(new_msg, shard);
+        return;
+    }
+    if (queue_type_ == async_queue_type::per_thread)
+    {
+        post_to_ring_(std::move(new_msg), overflow_policy);
+    }
+    else if (queue_type_ == async_queue_type::lockfree)
+    {
+        post_to_queue_(*lockfree_qs_[shard], std::move(new_msg), overflow_policy, shard);
+    }
+    else
+    {
+        post_to_queue_(*qs_[shard], std::move(new_msg), overflow_policy, shard);
+    }
+    // the workers of a shut down pool quit while the message was posted: either the last one
+    // drains the message or this thread sees stopped_ and does
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!terminate && stopped_.load(std::memory_order_relaxed))
+    {
+        drain_stopped_();
+    }
+}
+
+template<typename Q>
+void SPDLOG_INLINE thread_pool::post_to_queue_(Q &q, async_msg &&new_msg, async_overflow_policy overflow_policy, size_t shard)
 {
     if (overflow_policy == async_overflow_policy::block)
     {
-        q_.enqueue(std::move(new_msg));
+        q.enqueue(std::move(new_msg));
+    }
+    else if (overflow_policy == async_overflow_policy::overrun_oldest)
+    {
+        q.enqueue_nowait(std::move(new_msg), [this, shard](const async_msg &overrun) { this->count_dropped_(overrun, shard); });
+    }
+    else if (must_admit_(new_msg, overflow_policy))
+    {
+        q.enqueue(std::move(new_msg), admit_limit_(new_msg));
+    }
+    else if (!q.try_enqueue(std::move(new_msg), admit_limit_(new_msg)))
+    {
+        // not moved from if not enqueued
+        count_dropped_(new_msg, shard);
+    }
+}
+
+size_t SPDLOG_INLINE thread_pool::admit_limit_(const async_msg &msg) const
+{
+    if (msg.msg_type != async_msg_type::log || msg.level >= level::err)
+    {
+        return (std::numeric_limits<size_t>::max)();
+    }
+    return q_max_items_ - reserved_items_;
+}
+
+bool SPDLOG_INLINE thread_pool::must_admit_(const async_msg &msg, async_overflow_policy overflow_policy) const
+{
+    return overflow_policy == async_overflow_policy::block ||
+           (overflow_policy == async_overflow_policy::drop_below_level && msg.level >= priority_level_);
+}
+
+void SPDLOG_INLINE thread_pool::record_dequeued_(size_t shard, const async_msg *msgs, size_t count)
+{
+    size_t log_count = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        log_count += msgs[i].msg_type == async_msg_type::log ? 1 : 0;
+    }
+    dequeued_counter_.fetch_add(log_count, std::memory_order_relaxed);
+
+    // depth seen by this drain: what was taken plus what is still queued
+    size_t depth = count;
+    if (queue_type_ == async_queue_type::per_thread)
+    {
+        depth += queue_size();
+    }
+    else if (queue_type_ == async_queue_type::lockfree)
+    {
+        depth += lockfree_qs_[shard]->size();
     }
     else
     {
-        q_.enqueue_nowait(std::move(new_msg));
+        depth += qs_[shard]->size();
     }
+    size_t high_water = queue_high_water_.load(std::memory_order_relaxed);
+    while (depth > high_water && !queue_high_water_.compare_exchange_weak(high_water, depth, std::memory_order_relaxed)) {}
 }
 
-void SPDLOG_INLINE thread_pool::worker_loop_()
+void SPDLOG_INLINE thread_pool::record_latency_(const log_msg *const *msgs, size_t count)
 {
-    while (process_next_msg_()) {}
+    auto now = log_clock::now();
+    for (size_t i = 0; i < count; i++)
+    {
+        latency_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(now - msgs[i]->time));
+    }
 }
 
-// process next message in the queue
-// return true if this thread should still be active (while no terminate msg
-// was received)
-bool SPDLOG_INLINE thread_pool::process_next_msg_()
+void SPDLOG_INLINE thread_pool::count_dropped_(const async_msg &msg, size_t shard)
 {
-    async_msg incoming_async_msg;
-    bool dequeued = q_.dequeue_for(incoming_async_msg, std::chrono::seconds(10));
-    if (!dequeued)
+    if (msg.msg_type == async_msg_type::log)
     {
-        return true;
+        dropped_counters_[msg.level].fetch_add(1, std::memory_order_relaxed);
+        if (report_drops_ && msg.worker_ptr && msg.worker_ptr->note_dropped_(msg.time, shard))
+        {
+            std::lock_guard<std::mutex> lock(drops_pending_mutex_);
+            drops_pending_[shard].push_back(msg.worker_ptr);
+            any_drops_pending_[shard].store(true, std::memory_order_release);
+        }
     }
+}
 
-    switch (incoming_async_msg.msg_type)
+void SPDLOG_INLINE thread_pool::report_pending_drops_(size_t shard)
+{
+    std::vector<std::weak_ptr<async_logger>> loggers;
     {
-    case async_msg_type::log: {
-        incoming_async_msg.worker_ptr->backend_sink_it_(incoming_async_msg);
-        return true;
+        std::lock_guard<std::mutex> lock(drops_pending_mutex_);
+        loggers.swap(drops_pending_[shard]);
+        any_drops_pending_[shard].store(false, std::memory_order_relaxed);
     }
-    case async_msg_type::flush: {
-        incoming_async_msg.worker_ptr->backend_flush_();
-        return true;
+    for (auto &weak_logger : loggers)
+    {
+        // already reported (nothing left to report) if it logged since
+        if (auto logger = weak_logger.lock())
+        {
+            logger->backend_report_drops_(shard);
+        }
     }
+}
 
-    case async_msg_type::terminate: {
-        return false;
+// apply the thread attributes of the options to the calling worker thread
+void SPDLOG_INLINE thread_pool::setup_worker_(const thread_pool_options &options, size_t index)
+{
+    auto report = [index](const char *what) {
+        std::fprintf(stderr, "[*** LOG ERROR ***] [thread_pool] failed to set the %s of worker thread %zu\n", what, index);
+    };
+    if (!options.thread_name.empty() && !os::set_thread_name(options.thread_name + '-' + std::to_string(index)))
+    {
+        report("thread name");
+    }
+    if (!options.cpu_affinity.empty() && !os::set_thread_affinity(options.cpu_affinity))
+    {
+        report("cpu affinity");
+    }
+    if (options.nice != 0 && !os::set_thread_nice(options.nice))
+    {
+        report("nice value");
+    }
+    if (options.sched_idle && !os::set_thread_sched_idle())
+    {
+        report("SCHED_IDLE policy");
+    }
+}
+
+// the calling thread's ring for this pool, created and registered on first use
+SPDLOG_INLINE thread_pool::producer_ring &thread_pool::thread_ring_()
+{
+    struct ring_entry
+    {
+        size_t pool_id;
+        std::shared_ptr<producer_ring> ring;
+    };
+    static thread_local std::vector<ring_entry> t_rings;
+
+    for (auto &entry : t_rings)
+    {
+        if (entry.pool_id == pool_id_)
+        {
+            return *entry.ring;
+        }
     }
 
-    default: {
-        assert(false);
+    // forget rings of pools that no longer exist
+    for (auto it = t_rings.begin(); it != t_rings.end();)
+    {
+        it = it->ring.use_count() == 1 ? t_rings.erase(it) : it + 1;
     }
+
+    auto ring = std::make_shared<producer_ring>(ring_max_items_, ring_arena_size_);
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.push_back(ring);
     }
+    rings_version_.fetch_add(1, std::memory_order_release);
+    t_rings.push_back(ring_entry{pool_id_, ring});
+    return *ring;
+}
 
+void SPDLOG_INLINE thread_pool::post_to_ring_(async_msg &&new_msg, async_overflow_policy overflow_policy)
+{
+    // rings are merged by time, so flush requests need a timestamp too
+    if (new_msg.msg_type != async_msg_type::log)
+    {
+        new_msg.time = log_clock::now();
+    }
+
+    auto &ring = thread_ring_().queue;
+    bool must_admit = must_admit_(new_msg, overflow_policy);
+    bool use_reserve = overflow_policy == async_overflow_policy::discard_new || overflow_policy == async_overflow_policy::drop_below_level;
+    size_t max_size = use_reserve ? admit_limit_(new_msg) : ring.capacity();
+    while ((max_size < ring.capacity() && ring.size() >= max_size) || !ring.try_enqueue(std::move(new_msg)))
+    {
+        if (!must_admit)
+        {
+            // the producer cannot evict from its own ring, so the newest message is dropped instead
+            if (overflow_policy == async_overflow_policy::overrun_oldest)
+            {
+                rings_overrun_counter_.fetch_add(1, std::memory_order_relaxed);
+            }
+            // per_thread mode has a single shard
+            count_dropped_(new_msg, 0);
+            return;
+        }
+        if (stopped_.load(std::memory_order_acquire))
+        {
+            drain_stopped_();
+        }
+        wake_parked_worker_();
+        std::this_thread::yield();
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (worker_parked_.load(std::memory_order_relaxed))
+    {
+        wake_parked_worker_();
+    }
+}
+
+void SPDLOG_INLINE thread_pool::wake_parked_worker_()
+{
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    park_cv_.notify_all();
+}
+
+// pop the message with the oldest log time among the heads of all rings
+bool SPDLOG_INLINE thread_pool::pop_oldest_from_rings_(async_msg &popped_msg)
+{
+    if (worker_rings_version_ != rings_version_.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        worker_rings_version_ = rings_version_.load(std::memory_order_relaxed);
+        worker_rings_.clear();
+        for (auto &ring : rings_)
+        {
+            worker_rings_.push_back(&ring->queue);
+        }
+    }
+
+    spsc_q_type *oldest_ring = nullptr;
+    async_msg *oldest_msg = nullptr;
+    for (auto *ring : worker_rings_)
+    {
+        auto *msg = ring->front();
+        if (msg != nullptr && (oldest_msg == nullptr || msg->time < oldest_msg->time))
+        {
+            oldest_ring = ring;
+            oldest_msg = msg;
+        }
+    }
+    if (oldest_msg == nullptr)
+    {
+        return false;
+    }
+    popped_msg = std::move(*oldest_msg);
+    oldest_ring->pop_front();
     return true;
 }
 
+bool SPDLOG_INLINE thread_pool::dequeue_from_rings_for_(async_msg &popped_msg, std::chrono::milliseconds wait_duration)
+{
+    for (int spins = 0; spins < 64; spins++)
+    {
+        if (pop_oldest_from_rings_(popped_msg))
+        {
+            return true;
+        }
+    }
+
+    release_abandoned_rings_();
+
+    {
+        std::unique_lock<std::mutex> lock(park_mutex_);
+        worker_parked_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto version = worker_rings_version_;
+        park_cv_.wait_for(lock, wait_duration, [this, version] {
+            if (terminating_.load(std::memory_order_acquire) || version != rings_version_.load(std::memory_order_acquire))
+            {
+                return true;
+            }
+            for (auto *ring : worker_rings_)
+            {
+                if (!ring->empty())
+                {
+                    return true;
+                }
+            }
+            return false;
+        });
+        worker_parked_.store(false, std::memory_order_relaxed);
+    }
+    return pop_oldest_from_rings_(popped_msg);
+}
+
+// idle worker: release rings whose producer thread has exited
+void SPDLOG_INLINE thread_pool::release_abandoned_rings_()
+{
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    auto old_size = rings_.size();
+    for (auto it = rings_.begin(); it != rings_.end();)
+    {
+        it = ((*it).use_count() == 1 && (*it)->queue.empty()) ? rings_.erase(it) : it + 1;
+    }
+    if (rings_.size() != old_size)
+    {
+        worker_rings_version_ = rings_version_.fetch_add(1, std::memory_order_acq_rel) + 1;
+        worker_rings_.clear();
+        for (auto &ring : rings_)
+        {
+            worker_rings_.push_back(&ring->queue);
+        }
+    }
+}
+
+size_t SPDLOG_INLINE thread_pool::dequeue_bulk_for_(
+    size_t shard, async_msg *popped_msgs, size_t max_msgs, std::chrono::milliseconds wait_duration)
+{
+    switch (queue_type_)
+    {
+    case async_queue_type::lockfree:
+        return lockfree_qs_[shard]->dequeue_bulk_for(popped_msgs, max_msgs, wait_duration);
+    case async_queue_type::per_thread: {
+        if (!dequeue_from_rings_for_(popped_msgs[0], wait_duration))
+        {
+            return 0;
+        }
+        size_t count = 1;
+        while (count < max_msgs && pop_oldest_from_rings_(popped_msgs[count]))
+        {
+            count++;
+        }
+        return count;
+    }
+    default:
+        return qs_[shard]->dequeue_bulk_for(popped_msgs, max_msgs, wait_duration);
+    }
+}
+
+size_t SPDLOG_INLINE thread_pool::try_dequeue_bulk_(size_t shard, async_msg *popped_msgs, size_t max_msgs)
+{
+    switch (queue_type_)
+    {
+    case async_queue_type::lockfree:
+        return lockfree_qs_[shard]->try_dequeue_bulk(popped_msgs, max_msgs);
+    case async_queue_type::per_thread: {
+        size_t count = 0;
+        while (count < max_msgs && pop_oldest_from_rings_(popped_msgs[count]))
+        {
+            count++;
+        }
+        return count;
+    }
+    default:
+        return qs_[shard]->try_dequeue_bulk(popped_msgs, max_msgs);
+    }
+}
+
+// the worker never sleeps while spinning, so producers (which only wake sleeping
+// workers) make no system call at all.
+size_t SPDLOG_INLINE thread_pool::wait_dequeue_bulk_(
+    size_t shard, async_msg *popped_msgs, size_t max_msgs, std::chrono::milliseconds wait_duration)
+{
+    if (wait_strategy_ == async_wait_strategy::blocking)
+    {
+        return dequeue_bulk_for_(shard, popped_msgs, max_msgs, wait_duration);
+    }
+
+    for (size_t polls = 0;; polls++)
+    {
+        size_t count = try_dequeue_bulk_(shard, popped_msgs, max_msgs);
+        if (count > 0)
+        {
+            return count;
+        }
+        // per_thread mode has no terminate message, shut down pools do not wait for one
+        if (terminating_.load(std::memory_order_relaxed))
+        {
+            return 0;
+        }
+
+        switch (wait_strategy_)
+        {
+        case async_wait_strategy::spin_yield_park:
+            if (polls < spin_count_)
+            {
+                os::cpu_relax();
+            }
+            else if (polls < spin_count_ + yield_count_)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                return dequeue_bulk_for_(shard, popped_msgs, max_msgs, wait_duration);
+            }
+            break;
+        case async_wait_strategy::spin:
+            os::cpu_relax();
+            break;
+        default: // busy_poll
+            break;
+        }
+
+        // never sleeping: release the rings of exited threads from time to time
+        if (queue_type_ == async_queue_type::per_thread && (polls & 0xffff) == 0xffff)
+        {
+            release_abandoned_rings_();
+        }
+    }
+}
+
+void SPDLOG_INLINE thread_pool::worker_loop_(size_t shard)
+{
+    std::vector<async_msg> batch(batch_size_);
+    std::vector<const log_msg *> batch_msgs;
+    batch_msgs.reserve(batch_size_);
+    while (process_next_batch_(shard, batch, batch_msgs)) {}
+}
+
+// process the next batch of messages in the shard's queue (up to batch_size_)
+// consecutive log messages of the same logger are handed to its sinks at once.
+// return true if this thread should still be active (while no terminate msg
+// was received)
+bool SPDLOG_INLINE thread_pool::process_next_batch_(size_t shard, std::vector<async_msg> &batch, std::vector<const log_msg *> &batch_msgs)
+{
+    if (frozen_.load(std::memory_order_seq_cst))
+    {
+        park_frozen_();
+    }
+    size_t count = wait_dequeue_bulk_(shard, batch.data(), batch.size(), std::chrono::seconds(10));
+    if (count == 0)
+    {
+        // per_thread mode has no terminate message: quit once terminating and all queues are drained
+        return !terminating_.load(std::memory_order_acquire);
+    }
+    // busy from the dequeue until the batch is written, so that an idle worker waiting
+    // for messages does not hold up freeze_unsafe()
+    busy_workers_.fetch_add(1, std::memory_order_seq_cst);
+    if (frozen_.load(std::memory_order_seq_cst))
+    {
+        // frozen while dequeuing: the crash handler may already be writing to the sinks
+        busy_workers_.fetch_sub(1, std::memory_order_seq_cst);
+        park_frozen_();
+    }
+    if (telemetry_)
+    {
+        record_dequeued_(shard, batch.data(), count);
+    }
+
+    size_t terminate_count = 0;
+    bool discarding = discarding_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count;)
+    {
+        auto &incoming_async_msg = batch[i];
+        // shutdown timeout expired: drop the rest of the queue
+        if (discarding && incoming_async_msg.msg_type != async_msg_type::terminate)
+        {
+            count_dropped_(incoming_async_msg, shard);
+            i++;
+            continue;
+        }
+        switch (incoming_async_msg.msg_type)
+        {
+        case async_msg_type::log: {
+            batch_msgs.clear();
+            if (report_drops_)
+            {
+                incoming_async_msg.worker_ptr->backend_report_drops_(shard);
+            }
+            size_t end = i;
+            while (end < count && batch[end].msg_type == async_msg_type::log && batch[end].worker_ptr == incoming_async_msg.worker_ptr)
+            {
+                // deferred messages are formatted here, the ones that fail to format are dropped
+                if (batch[end].format_fn == nullptr || incoming_async_msg.worker_ptr->backend_format_(batch[end]))
+                {
+                    batch_msgs.push_back(&batch[end]);
+                }
+                end++;
+            }
+            if (!batch_msgs.empty())
+            {
+                incoming_async_msg.worker_ptr->backend_sink_batch_(batch_msgs.data(), batch_msgs.size(), shard);
+                if (telemetry_)
+                {
+                    record_latency_(batch_msgs.data(), batch_msgs.size());
+                }
+            }
+            i = end;
+            break;
+        }
+        case async_msg_type::flush: {
+            if (report_drops_)
+            {
+                incoming_async_msg.worker_ptr->backend_report_drops_(shard);
+            }
+            incoming_async_msg.worker_ptr->backend_flush_(shard);
+            i++;
+            break;
+        }
+        case async_msg_type::terminate: {
+            terminate_count++;
+            i++;
+            break;
+        }
+        default: {
+            assert(false);
+            i++;
+        }
+        }
+    }
+
+    // release the loggers and the arena blocks held by the processed messages
+    for (size_t i = 0; i < count; i++)
+    {
+        batch[i].release();
+    }
+    busy_workers_.fetch_sub(1, std::memory_order_seq_cst);
+
+    if (report_drops_ && any_drops_pending_[shard].load(std::memory_order_acquire))
+    {
+        report_pending_drops_(shard);
+    }
+
+    // one terminate message per worker: hand back the ones meant for other workers
+    // (shut down pools: only to wake them up, see stop_workers_())
+    auto terminate_policy = terminating_.load(std::memory_order_acquire) ? async_overflow_policy::discard_new : async_overflow_policy::block;
+    for (size_t i = 1; i < terminate_count; i++)
+    {
+        post_async_msg_(async_msg(async_msg_type::terminate), terminate_policy, shard);
+    }
+    return terminate_count == 0;
+}
+
 } // namespace details
 } // namespace spdlog
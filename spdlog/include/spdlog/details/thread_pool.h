@@ -3,12 +3,22 @@
 
 #pragma once
 
-#include <spdlog/details/log_msg_buffer.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/deferred_args.h>
+#include <spdlog/details/byte_arena.h>
 #include <spdlog/details/mpmc_blocking_q.h>
+#include <spdlog/details/mpmc_lockfree_q.h>
+#include <spdlog/details/spsc_ring_q.h>
+#include <spdlog/details/telemetry.h>
 #include <spdlog/details/os.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
 #include <vector>
 #include <functional>
@@ -20,6 +30,94 @@ namespace details {
 
 using async_logger_ptr = std::shared_ptr<spdlog::async_logger>;
 
+// Queue implementation used by the thread pool
+enum class async_queue_type
+{
+    blocking, // mutex + condition variables (mpmc_blocking_queue)
+    lockfree, // per slot sequence numbers, consumer woken only when parked (mpmc_lockfree_queue)
+    per_thread // one spsc ring per producer thread, merged by log time in the (single) worker
+};
+
+// How an idle worker waits for new messages
+enum class async_wait_strategy
+{
+    blocking,        // sleep on the queue until a producer wakes it up
+    spin,            // spin with a cpu pause instruction, never sleep
+    spin_yield_park, // spin (spin_count), then yield (yield_count), then sleep like blocking
+    busy_poll        // poll without any pause, for workers pinned to a dedicated core
+};
+
+// How messages are spread over the workers
+enum class async_sharding
+{
+    none,   // all workers pull from one shared queue (no ordering between workers)
+    logger, // one queue per worker, each async_logger is assigned to one worker
+    sink    // one queue per worker, each sink is assigned to one worker (a message is queued
+            // once per worker owning one of its logger's sinks)
+};
+
+// Thread pool construction options
+struct thread_pool_options
+{
+    async_queue_type queue_type = async_queue_type::blocking;
+    // max number of messages the worker drains at once and hands to the sinks as one batch
+    size_t batch_size = 64;
+    // bytes pre allocated for the queued logger names and payloads (0: 128 bytes per queue item).
+    // blocking queue: one arena shared by the producers (allocations take a spin lock).
+    // per_thread queue: one arena per producer ring, without lock. lockfree queue: no arena,
+    // the payloads are on the heap (a shared arena would serialize the producers).
+    size_t arena_size = 0;
+    // idle worker wait strategy. producers skip the wake up call while the worker is spinning.
+    async_wait_strategy wait_strategy = async_wait_strategy::blocking;
+    // spin_yield_park thresholds (empty polls before yielding / before sleeping)
+    size_t spin_count = 4096;
+    size_t yield_count = 64;
+    // worker thread attributes (best effort, failures are reported to stderr)
+    // workers are named "<thread_name>-<index>" (empty: keep the default name)
+    std::string thread_name;
+    // cpus the workers may run on (empty: any cpu). linux only.
+    std::vector<int> cpu_affinity;
+    // nice value of the workers (0: unchanged). linux only.
+    int nice = 0;
+    // run the workers with the SCHED_IDLE policy. linux only.
+    bool sched_idle = false;
+    // sharded pools keep the messages of a logger (or sink) in order on a single worker,
+    // each worker has its own queue of q_max_items.
+    async_sharding sharding = async_sharding::none;
+    // drop_below_level policy: messages at or above this level are always admitted
+    // (the caller blocks if needed), the others are discarded when the queue is full.
+    level::level_enum priority_level = level::warn;
+    // queue slots reserved for err and critical messages: with the discard_new and
+    // drop_below_level policies, lower levels only use the first q_max_items - reserved_items slots.
+    size_t reserved_items = 0;
+    // log a "dropped N messages (...) since hh:mm:ss.mmm" warning to the sinks of a logger
+    // when some of its messages were dropped: by the worker, before the next messages or flush of
+    // the logger, or right after the batch it was draining when the drops happened (quiet loggers).
+    bool report_drops = false;
+    // track the dequeued count, the queue high-water mark and the log-to-sink latency
+    // (a few relaxed atomic updates per drained batch, on the worker only)
+    bool telemetry = false;
+};
+
+// snapshot of the pool counters, see thread_pool::stats()
+struct thread_pool_stats
+{
+    // telemetry option only (zero otherwise)
+    uint64_t enqueued = 0; // dequeued + queue_depth + overrun
+    uint64_t dequeued = 0;
+    size_t queue_high_water = 0;
+    // time from log_msg::time (the log call) to the end of the sink write, per message
+    latency_summary latency;
+
+    // always tracked
+    size_t queue_depth = 0;
+    size_t overrun = 0;
+    size_t dropped = 0;
+    size_t dropped_per_level[level::n_levels] = {};
+    // messages stored on the heap because the byte arena was full (all of them with the lockfree queue)
+    size_t heap_payloads = 0;
+};
+
 enum class async_msg_type
 {
     log,
@@ -29,46 +127,66 @@ enum class async_msg_type
 
 // Async msg to move to/from the queue
 // Movable only. should never be copied
-struct async_msg : log_msg_buffer
+// The queue slot only holds the message header, the logger name and the payload
+// are stored contiguously in a byte arena (or on the heap if there is none or it is full).
+struct async_msg : log_msg
 {
     async_msg_type msg_type{async_msg_type::log};
     async_logger_ptr worker_ptr;
+    // set if the payload holds encoded arguments to be formatted by the worker
+    deferred_format_fn format_fn{nullptr};
 
     async_msg() = default;
-    ~async_msg() = default;
+    ~async_msg()
+    {
+        release_storage_();
+    }
 
     // should only be moved in or out of the queue..
     async_msg(const async_msg &) = delete;
 
-// support for vs2013 move
-#if defined(_MSC_VER) && _MSC_VER <= 1800
-    async_msg(async_msg &&other)
-        : log_msg_buffer(std::move(other))
-        , msg_type(other.msg_type)
-        , worker_ptr(std::move(other.worker_ptr))
-    {}
+    async_msg(async_msg &&other) SPDLOG_NOEXCEPT : log_msg(other),
+                                                   msg_type(other.msg_type),
+                                                   worker_ptr(std::move(other.worker_ptr)),
+                                                   format_fn(other.format_fn),
+                                                   arena_(other.arena_),
+                                                   storage_(other.storage_),
+                                                   in_arena_(other.in_arena_)
+    {
+        other.storage_ = nullptr;
+    }
 
-    async_msg &operator=(async_msg &&other)
+    async_msg &operator=(async_msg &&other) SPDLOG_NOEXCEPT
     {
-        *static_cast<log_msg_buffer *>(this) = std::move(other);
-        msg_type = other.msg_type;
-        worker_ptr = std::move(other.worker_ptr);
+        if (this != &other)
+        {
+            release_storage_();
+            log_msg::operator=(other);
+            msg_type = other.msg_type;
+            worker_ptr = std::move(other.worker_ptr);
+            format_fn = other.format_fn;
+            arena_ = other.arena_;
+            storage_ = other.storage_;
+            in_arena_ = other.in_arena_;
+            other.storage_ = nullptr;
+        }
         return *this;
     }
-#else // (_MSC_VER) && _MSC_VER <= 1800
-    async_msg(async_msg &&) = default;
-    async_msg &operator=(async_msg &&) = default;
-#endif
 
     // construct from log_msg with given type
-    async_msg(async_logger_ptr &&worker, async_msg_type the_type, const details::log_msg &m)
-        : log_msg_buffer{m}
+    async_msg(async_logger_ptr &&worker, async_msg_type the_type, const details::log_msg &m, byte_arena *arena,
+        deferred_format_fn fn = nullptr)
+        : log_msg{m}
         , msg_type{the_type}
         , worker_ptr{std::move(worker)}
-    {}
+        , format_fn{fn}
+        , arena_{arena}
+    {
+        store_(m.logger_name, m.payload);
+    }
 
     async_msg(async_logger_ptr &&worker, async_msg_type the_type)
-        : log_msg_buffer{}
+        : log_msg{}
         , msg_type{the_type}
         , worker_ptr{std::move(worker)}
     {}
@@ -76,6 +194,71 @@ struct async_msg : log_msg_buffer
     explicit async_msg(async_msg_type the_type)
         : async_msg{nullptr, the_type}
     {}
+
+    // drop the logger reference and free the storage of a processed message
+    // (the arena only reclaims in allocation order: a kept message pins the blocks after it)
+    void release()
+    {
+        worker_ptr.reset();
+        release_storage_();
+    }
+
+    bool in_arena() const
+    {
+        return in_arena_;
+    }
+
+    // replace the payload (new_payload must not point into this message)
+    void set_payload(string_view_t new_payload)
+    {
+        char *old_storage = storage_;
+        bool old_in_arena = in_arena_;
+        store_(logger_name, new_payload);
+        release_(old_storage, old_in_arena);
+    }
+
+private:
+    byte_arena *arena_{nullptr};
+    char *storage_{nullptr};
+    bool in_arena_{false};
+
+    // copy the logger name and the payload to new storage and point the string views to it
+    void store_(string_view_t name, string_view_t new_payload)
+    {
+        size_t size = name.size() + new_payload.size();
+        storage_ = arena_ != nullptr ? arena_->allocate(size) : nullptr;
+        in_arena_ = storage_ != nullptr;
+        if (storage_ == nullptr)
+        {
+            storage_ = new char[size];
+        }
+        std::copy(name.begin(), name.end(), storage_);
+        std::copy(new_payload.begin(), new_payload.end(), storage_ + name.size());
+        logger_name = string_view_t{storage_, name.size()};
+        payload = string_view_t{storage_ + name.size(), new_payload.size()};
+    }
+
+    void release_(char *storage, bool in_arena)
+    {
+        if (storage == nullptr)
+        {
+            return;
+        }
+        if (in_arena)
+        {
+            arena_->deallocate(storage);
+        }
+        else
+        {
+            delete[] storage;
+        }
+    }
+
+    void release_storage_()
+    {
+        release_(storage_, in_arena_);
+        storage_ = nullptr;
+    }
 };
 
 class SPDLOG_API thread_pool
@@ -83,34 +266,185 @@ class SPDLOG_API thread_pool
 public:
     using item_type = async_msg;
     using q_type = details::mpmc_blocking_queue<item_type>;
+    using lockfree_q_type = details::mpmc_lockfree_queue<item_type>;
+    using spsc_q_type = details::spsc_ring_queue<item_type>;
 
+    thread_pool(size_t q_max_items, size_t threads_n, const thread_pool_options &options, std::function<void()> on_thread_start,
+        std::function<void()> on_thread_stop);
     thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start, std::function<void()> on_thread_stop);
     thread_pool(size_t q_max_items, size_t threads_n, std::function<void()> on_thread_start);
+    thread_pool(size_t q_max_items, size_t threads_n, const thread_pool_options &options);
+    thread_pool(size_t q_max_items, size_t threads_n, async_queue_type queue_type);
     thread_pool(size_t q_max_items, size_t threads_n);
 
-    // message all threads to terminate gracefully and join them
+    // message all threads to terminate gracefully and join them (unless already shut down)
     ~thread_pool();
 
     thread_pool(const thread_pool &) = delete;
     thread_pool &operator=(thread_pool &&) = delete;
 
-    void post_log(async_logger_ptr &&worker_ptr, const details::log_msg &msg, async_overflow_policy overflow_policy);
-    void post_flush(async_logger_ptr &&worker_ptr, async_overflow_policy overflow_policy);
+    void post_log(async_logger_ptr &&worker_ptr, const details::log_msg &msg, async_overflow_policy overflow_policy,
+        deferred_format_fn format_fn = nullptr, size_t shard = 0);
+    void post_flush(async_logger_ptr &&worker_ptr, async_overflow_policy overflow_policy, size_t shard = 0);
     size_t overrun_counter();
     size_t queue_size();
 
+    // number of log messages lost to the overflow policies (overrun, discarded or shed)
+    size_t dropped_counter(level::level_enum lvl) const;
+    size_t dropped_counter() const;
+
+    // counters snapshot (see thread_pool_options::telemetry)
+    thread_pool_stats stats();
+
+    // bounded time shutdown: stop accepting messages, let the workers drain the queues
+    // until the timeout, then discard what is left and join the workers.
+    // returns at most 100ms after the timeout: a worker still busy in a sink by then is left to
+    // finish its current batch (and discard the rest) and is joined by the destructor.
+    // messages posted from now on are dropped. the sinks are not flushed.
+    // return the number of log messages dropped during the shutdown (also counted by dropped_counter()).
+    // not thread safe: call it once, from one thread.
+    size_t shutdown(std::chrono::milliseconds timeout);
+
+    // crash handler support: call visitor(msg, ctx) for each queued log message whose payload is
+    // already formatted (deferred messages are skipped), oldest first within each queue.
+    // takes no lock and allocates nothing, so it may be called from a fatal signal handler.
+    // messages dequeued concurrently may be torn.
+    using crash_visitor = void (*)(const log_msg &msg, void *ctx);
+    void visit_queued_unsafe(crash_visitor visitor, void *ctx) const;
+
+    // crash handler support: stop the workers for good once they have written the batch in hand,
+    // so that the queued messages can be visited safely. wait up to timeout for the busy workers
+    // (idle workers waiting for messages are not waited for, a batch they dequeue from now on is
+    // never written). only uses atomics, clock_gettime and nanosleep.
+    // return false on timeout (e.g. a sink is stuck, or the crashed thread is a worker): the workers
+    // may still be using the queues and the sinks.
+    bool freeze_unsafe(std::chrono::milliseconds timeout);
+
+    async_queue_type queue_type() const;
+    async_sharding sharding() const;
+    size_t shards_count() const;
+
+    // shard (worker) of the given key: the same key is always assigned to the same shard,
+    // new keys are assigned round robin. always 0 if the pool is not sharded.
+    size_t assign_shard(const void *key);
+
 private:
-    q_type q_;
+    // per_thread mode: the ring of a producer thread and the arena of its messages (that thread
+    // is the only one allocating from it)
+    struct producer_ring
+    {
+        producer_ring(size_t max_items, size_t arena_size)
+            : arena(arena_size, false)
+            , queue(max_items)
+        {}
+
+        // declared first: outlives the queued messages
+        byte_arena arena;
+        spsc_q_type queue;
+    };
+
+    async_queue_type queue_type_;
+    size_t batch_size_;
+    async_wait_strategy wait_strategy_;
+    size_t spin_count_;
+    size_t yield_count_;
+    async_sharding sharding_;
+    size_t q_max_items_;
+    level::level_enum priority_level_;
+    size_t reserved_items_;
+    bool report_drops_;
+    // loggers with unreported drops, per shard (report_drops option)
+    std::mutex drops_pending_mutex_;
+    std::vector<std::vector<std::weak_ptr<async_logger>>> drops_pending_;
+    std::unique_ptr<std::atomic<bool>[]> any_drops_pending_;
+    bool telemetry_;
+    std::atomic<uint64_t> dequeued_counter_{0};
+    std::atomic<size_t> queue_high_water_{0};
+    latency_histogram latency_;
+    std::atomic<size_t> dropped_counters_[level::n_levels];
+    // shutdown state: producers are rejected, then (past the timeout) the workers discard
+    std::atomic<bool> accepting_{true};
+    std::atomic<bool> discarding_{false};
+    // running workers per shard (a shut down worker quits once its queue is empty, see terminating_)
+    std::unique_ptr<std::atomic<size_t>[]> running_workers_;
+    // set once the workers of a shut down pool have quit: producers drop what they queued meanwhile
+    std::atomic<bool> stopped_{false};
+    std::mutex stopped_mutex_;
+    // crash handler state (see freeze_unsafe())
+    std::atomic<bool> frozen_{false};
+    std::atomic<size_t> busy_workers_{0};
+    // blocking queue only (see thread_pool_options::arena_size)
+    std::unique_ptr<byte_arena> arena_;
+    std::atomic<size_t> heap_payloads_{0};
+    // one queue per shard
+    std::vector<std::unique_ptr<q_type>> qs_;
+    std::vector<std::unique_ptr<lockfree_q_type>> lockfree_qs_;
+    std::mutex shards_mutex_;
+    std::vector<std::pair<const void *, size_t>> assigned_shards_;
+    size_t next_shard_ = 0;
+
+    // per_thread mode: rings registered by producer threads (lazily, on first post)
+    size_t ring_max_items_ = 0;
+    size_t ring_arena_size_ = 0;
+    size_t pool_id_ = 0;
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<producer_ring>> rings_;
+    std::atomic<size_t> rings_version_{0};
+    std::atomic<size_t> rings_overrun_counter_{0};
+    // set by shutdown() (and by the destructor of per_thread pools): the workers quit once their queue is empty
+    std::atomic<bool> terminating_{false};
+    // worker side copy of the queues of rings_ (raw pointers, rings_ keeps them alive)
+    std::vector<spsc_q_type *> worker_rings_;
+    size_t worker_rings_version_ = 0;
+    // worker parking
+    std::mutex park_mutex_;
+    std::condition_variable park_cv_;
+    std::atomic<bool> worker_parked_{false};
 
     std::vector<std::thread> threads_;
 
-    void post_async_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy);
-    void worker_loop_();
+    void post_async_msg_(async_msg &&new_msg, async_overflow_policy overflow_policy, size_t shard);
+    // message all threads to terminate and join them
+    void join_workers_();
+    // wake the workers until they have quit (see terminating_) or the deadline, return true if they all did
+    bool stop_workers_(std::chrono::steady_clock::time_point deadline);
+    // drop the queued messages once the workers are joined (see stopped_)
+    void drain_stopped_();
+    // called by each worker thread when it quits
+    void worker_stopped_(size_t shard);
+    size_t shard_queue_size_(size_t shard);
+    template<typename Q>
+    void post_to_queue_(Q &q, async_msg &&new_msg, async_overflow_policy overflow_policy, size_t shard);
+    // max number of queued messages a new message may find (lower levels can't use the reserved slots)
+    size_t admit_limit_(const async_msg &msg) const;
+    // true if the policy must not discard the message
+    bool must_admit_(const async_msg &msg, async_overflow_policy overflow_policy) const;
+    void count_dropped_(const async_msg &msg, size_t shard);
+    // report the drops of loggers that may log nothing more (see drops_pending_)
+    void report_pending_drops_(size_t shard);
+    [[noreturn]] static void park_frozen_();
+    // telemetry, called by the worker
+    void record_dequeued_(size_t shard, const async_msg *msgs, size_t count);
+    void record_latency_(const log_msg *const *msgs, size_t count);
+    static void setup_worker_(const thread_pool_options &options, size_t index);
+    void worker_loop_(size_t shard);
+
+    // per_thread mode helpers
+    producer_ring &thread_ring_();
+    void post_to_ring_(async_msg &&new_msg, async_overflow_policy overflow_policy);
+    void wake_parked_worker_();
+    bool pop_oldest_from_rings_(async_msg &popped_msg);
+    bool dequeue_from_rings_for_(async_msg &popped_msg, std::chrono::milliseconds wait_duration);
+    void release_abandoned_rings_();
+    size_t dequeue_bulk_for_(size_t shard, async_msg *popped_msgs, size_t max_msgs, std::chrono::milliseconds wait_duration);
+    size_t try_dequeue_bulk_(size_t shard, async_msg *popped_msgs, size_t max_msgs);
+    // dequeue according to wait_strategy_
+    size_t wait_dequeue_bulk_(size_t shard, async_msg *popped_msgs, size_t max_msgs, std::chrono::milliseconds wait_duration);
 
-    // process next message in the queue
+    // process the next batch of messages in the shard's queue (up to batch_size_)
     // return true if this thread should still be active (while no terminate msg
     // was received)
-    bool process_next_msg_();
+    bool process_next_batch_(size_t shard, std::vector<async_msg> &batch, std::vector<const log_msg *> &batch_msgs);
 };
 
 } // namespace details
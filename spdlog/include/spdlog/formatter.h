@@ -6,6 +6,8 @@
 #include <spdlog/fmt/fmt.h>
 #include <spdlog/details/log_msg.h>
 
+#include <string>
+
 namespace spdlog {
 
 class formatter
@@ -14,5 +16,12 @@ public:
     virtual ~formatter() = default;
     virtual void format(const details::log_msg &msg, memory_buf_t &dest) = 0;
     virtual std::unique_ptr<formatter> clone() const = 0;
+    // formatters of the same non empty identity (e.g. pattern, time type and eol) give the same
+    // output for any message, so sinks using them may share one formatted copy of a message.
+    // default: empty (never shared).
+    virtual std::string identity() const
+    {
+        return std::string();
+    }
 };
 } // namespace spdlog
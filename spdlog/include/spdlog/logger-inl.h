@@ -23,6 +23,7 @@ SPDLOG_INLINE logger::logger(const logger &other)
     , flush_level_(other.flush_level_.load(std::memory_order_relaxed))
     , custom_err_handler_(other.custom_err_handler_)
     , tracer_(other.tracer_)
+    , deferred_formatting_(other.deferred_formatting_)
 {}
 
 SPDLOG_INLINE logger::logger(logger &&other) SPDLOG_NOEXCEPT : name_(std::move(other.name_)),
@@ -30,7 +31,8 @@ SPDLOG_INLINE logger::logger(logger &&other) SPDLOG_NOEXCEPT : name_(std::move(o
                                                                level_(other.level_.load(std::memory_order_relaxed)),
                                                                flush_level_(other.flush_level_.load(std::memory_order_relaxed)),
                                                                custom_err_handler_(std::move(other.custom_err_handler_)),
-                                                               tracer_(std::move(other.tracer_))
+                                                               tracer_(std::move(other.tracer_)),
+                                                               deferred_formatting_(other.deferred_formatting_)
 
 {}
 
@@ -57,6 +59,7 @@ SPDLOG_INLINE void logger::swap(spdlog::logger &other) SPDLOG_NOEXCEPT
 
     custom_err_handler_.swap(other.custom_err_handler_);
     std::swap(tracer_, other.tracer_);
+    std::swap(deferred_formatting_, other.deferred_formatting_);
 }
 
 SPDLOG_INLINE void swap(logger &a, logger &b)
@@ -177,22 +180,76 @@ SPDLOG_INLINE void logger::log_it_(const spdlog::details::log_msg &log_msg, bool
 
 SPDLOG_INLINE void logger::sink_it_(const details::log_msg &msg)
 {
-    for (auto &sink : sinks_)
+    log_to_sinks_(msg);
+
+    if (should_flush_(msg))
     {
-        if (sink->should_log(msg.level))
+        flush_();
+    }
+}
+
+SPDLOG_INLINE void logger::log_to_sinks_(const details::log_msg &msg)
+{
+    // the message formatted by a formatter of id shared_id, with the color range it set
+    memory_buf_t shared;
+    size_t shared_id = 0;
+    size_t color_range_start = 0;
+    size_t color_range_end = 0;
+    for (size_t i = 0; i < sinks_.size(); i++)
+    {
+        auto &sink = sinks_[i];
+        if (!sink->should_log(msg.level))
+        {
+            continue;
+        }
+        SPDLOG_TRY
         {
-            SPDLOG_TRY
+            size_t id = sinks_.size() > 1 ? sink->formatter_id() : 0;
+            if (id != 0 && id != shared_id && shares_formatter_(i, id, msg.level))
+            {
+                shared.clear();
+                shared_id = 0;
+                msg.color_range_start = 0;
+                msg.color_range_end = 0;
+                shared_id = sink->format(msg, shared);
+                color_range_start = msg.color_range_start;
+                color_range_end = msg.color_range_end;
+            }
+            if (id != 0 && id == shared_id)
+            {
+                msg.color_range_start = color_range_start;
+                msg.color_range_end = color_range_end;
+                sink->log_formatted(msg, shared_id, string_view_t(shared.data(), shared.size()));
+            }
+            else
             {
                 sink->log(msg);
             }
-            SPDLOG_LOGGER_CATCH(msg.source)
         }
+        SPDLOG_LOGGER_CATCH(msg.source)
     }
+}
 
-    if (should_flush_(msg))
+SPDLOG_INLINE bool logger::shares_formatter_(size_t index, size_t formatter_id, level::level_enum msg_level) const
+{
+    for (size_t i = index + 1; i < sinks_.size(); i++)
     {
-        flush_();
+        if (sinks_[i]->should_log(msg_level) && sinks_[i]->formatter_id() == formatter_id)
+        {
+            return true;
+        }
     }
+    return false;
+}
+
+// loggers that cannot defer formatting just format right away
+SPDLOG_INLINE void logger::sink_deferred_(const details::log_msg &msg, details::deferred_format_fn format_fn)
+{
+    memory_buf_t buf;
+    format_fn(buf, msg.payload);
+    details::log_msg formatted_msg(msg);
+    formatted_msg.payload = string_view_t(buf.data(), buf.size());
+    sink_it_(formatted_msg);
 }
 
 SPDLOG_INLINE void logger::flush_()
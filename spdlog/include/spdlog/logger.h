@@ -17,6 +17,7 @@
 #include <spdlog/common.h>
 #include <spdlog/details/log_msg.h>
 #include <spdlog/details/backtracer.h>
+#include <spdlog/details/deferred_args.h>
 
 #ifdef SPDLOG_WCHAR_TO_UTF8_SUPPORT
 #    ifndef _WIN32
@@ -350,6 +351,8 @@ protected:
     spdlog::level_t flush_level_{level::off};
     err_handler custom_err_handler_{nullptr};
     details::backtracer tracer_;
+    // hand encoded arguments to sink_deferred_() instead of formatting them (see async_logger)
+    bool deferred_formatting_{false};
 
     // common implementation for after templated public api has been resolved
     template<typename... Args>
@@ -366,6 +369,11 @@ protected:
 #ifdef SPDLOG_USE_STD_FORMAT
             memory_buf_t buf = std::vformat(fmt, std::make_format_args(std::forward<Args>(args)...));
 #else
+            if (deferred_formatting_ && !traceback_enabled &&
+                log_deferred_(details::deferred::all_supported<typename std::decay<Args>::type...>(), loc, lvl, fmt, args...))
+            {
+                return;
+            }
             memory_buf_t buf;
             fmt::detail::vformat_to(buf, fmt, fmt::make_format_args(std::forward<Args>(args)...));
 #endif
@@ -375,6 +383,26 @@ protected:
         SPDLOG_LOGGER_CATCH(loc)
     }
 
+#ifndef SPDLOG_USE_STD_FORMAT
+    // encode the format string and the arguments, the payload of the message is the encoded buffer
+    template<typename... Args>
+    bool log_deferred_(std::true_type, source_loc loc, level::level_enum lvl, string_view_t fmt, const Args &... args)
+    {
+        memory_buf_t buf;
+        details::deferred::encode<typename std::decay<const Args>::type...>(buf, fmt, args...);
+        details::log_msg log_msg(loc, name_, lvl, string_view_t(buf.data(), buf.size()));
+        sink_deferred_(log_msg, &details::deferred::format<typename std::decay<const Args>::type...>);
+        return true;
+    }
+
+    // some argument type cannot be encoded: format on the calling thread
+    template<typename... Args>
+    bool log_deferred_(std::false_type, source_loc, level::level_enum, string_view_t, const Args &...)
+    {
+        return false;
+    }
+#endif
+
 #ifdef SPDLOG_WCHAR_TO_UTF8_SUPPORT
     template<typename... Args>
     void log_(source_loc loc, level::level_enum lvl, wstring_view_t fmt, Args &&... args)
@@ -429,9 +457,15 @@ protected:
     // and save backtrace (if backtrace is enabled).
     void log_it_(const details::log_msg &log_msg, bool log_enabled, bool traceback_enabled);
     virtual void sink_it_(const details::log_msg &msg);
+    // msg.payload holds the encoded arguments, format_fn turns them into the final payload
+    virtual void sink_deferred_(const details::log_msg &msg, details::deferred_format_fn format_fn);
     virtual void flush_();
     void dump_backtrace_();
     bool should_flush_(const details::log_msg &msg);
+    // log the message to the sinks of its level. sinks with the same formatter id share one formatted copy.
+    void log_to_sinks_(const details::log_msg &msg);
+    // true if a sink after sinks_[index] logs the level with the given formatter id
+    bool shares_formatter_(size_t index, size_t formatter_id, level::level_enum msg_level) const;
 
     // handle errors during logging.
     // default handler prints the error to stderr at max rate of 1 message/sec.
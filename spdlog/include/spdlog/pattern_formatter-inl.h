@@ -951,25 +951,35 @@ public:
         if (cache_timestamp_ != secs || cached_datetime_.size() == 0)
         {
             cached_datetime_.clear();
-            cached_datetime_.push_back('[');
-            fmt_helper::append_int(tm_time.tm_year + 1900, cached_datetime_);
-            cached_datetime_.push_back('-');
-
-            fmt_helper::pad2(tm_time.tm_mon + 1, cached_datetime_);
-            cached_datetime_.push_back('-');
+            // "YYYYMMDD00hhmmss" converted at once, unless a field doesn't fit (years below 1000 aren't padded)
+            char digits[16];
+            if (fmt_helper::write_tm_digits(digits, tm_time) && digits[0] != '0')
+            {
+                const char text[] = {'[', digits[0], digits[1], digits[2], digits[3], '-', digits[4], digits[5], '-', digits[6],
+                    digits[7], ' ', digits[10], digits[11], ':', digits[12], digits[13], ':', digits[14], digits[15], '.'};
+                cached_datetime_.append(text, text + sizeof(text));
+            }
+            else
+            {
+                cached_datetime_.push_back('[');
+                fmt_helper::append_int(tm_time.tm_year + 1900, cached_datetime_);
+                cached_datetime_.push_back('-');
 
-            fmt_helper::pad2(tm_time.tm_mday, cached_datetime_);
-            cached_datetime_.push_back(' ');
+                fmt_helper::pad2(tm_time.tm_mon + 1, cached_datetime_);
+                cached_datetime_.push_back('-');
 
-            fmt_helper::pad2(tm_time.tm_hour, cached_datetime_);
-            cached_datetime_.push_back(':');
+                fmt_helper::pad2(tm_time.tm_mday, cached_datetime_);
+                cached_datetime_.push_back(' ');
 
-            fmt_helper::pad2(tm_time.tm_min, cached_datetime_);
-            cached_datetime_.push_back(':');
+                fmt_helper::pad2(tm_time.tm_hour, cached_datetime_);
+                cached_datetime_.push_back(':');
 
-            fmt_helper::pad2(tm_time.tm_sec, cached_datetime_);
-            cached_datetime_.push_back('.');
+                fmt_helper::pad2(tm_time.tm_min, cached_datetime_);
+                cached_datetime_.push_back(':');
 
+                fmt_helper::pad2(tm_time.tm_sec, cached_datetime_);
+                cached_datetime_.push_back('.');
+            }
             cache_timestamp_ = secs;
         }
         dest.append(cached_datetime_.begin(), cached_datetime_.end());
@@ -1017,6 +1027,196 @@ private:
     memory_buf_t cached_datetime_;
 };
 
+///////////////////////////////////////////////////////////////////////
+// compiled pattern helpers
+///////////////////////////////////////////////////////////////////////
+
+static size_t time_field_width(time_span::field kind)
+{
+    switch (kind)
+    {
+    case time_span::field::year:
+        return 4;
+    case time_span::field::millis:
+        return 3;
+    case time_span::field::micros:
+        return 6;
+    case time_span::field::nanos:
+        return 9;
+    default:
+        return 2;
+    }
+}
+
+// field by field, as the flag_formatters do (values that don't fit the fixed width, e.g. year 12345)
+static void format_time_span_slow(const time_span &span, const log_msg &msg, const std::tm &tm_time, memory_buf_t &dest)
+{
+    using std::chrono::microseconds;
+    using std::chrono::milliseconds;
+    using std::chrono::nanoseconds;
+
+    size_t pos = 0;
+    for (auto &f : span.fields)
+    {
+        dest.append(span.text.data() + pos, span.text.data() + f.offset);
+        switch (f.kind)
+        {
+        case time_span::field::year:
+            fmt_helper::append_int(tm_time.tm_year + 1900, dest);
+            break;
+        case time_span::field::year2:
+            fmt_helper::pad2(tm_time.tm_year % 100, dest);
+            break;
+        case time_span::field::month:
+            fmt_helper::pad2(tm_time.tm_mon + 1, dest);
+            break;
+        case time_span::field::day:
+            fmt_helper::pad2(tm_time.tm_mday, dest);
+            break;
+        case time_span::field::hour:
+            fmt_helper::pad2(tm_time.tm_hour, dest);
+            break;
+        case time_span::field::hour12:
+            fmt_helper::pad2(to12h(tm_time), dest);
+            break;
+        case time_span::field::minute:
+            fmt_helper::pad2(tm_time.tm_min, dest);
+            break;
+        case time_span::field::second:
+            fmt_helper::pad2(tm_time.tm_sec, dest);
+            break;
+        case time_span::field::ampm:
+            fmt_helper::append_string_view(ampm(tm_time), dest);
+            break;
+        case time_span::field::millis:
+            fmt_helper::pad3(static_cast<uint32_t>(fmt_helper::time_fraction<milliseconds>(msg.time).count()), dest);
+            break;
+        case time_span::field::micros:
+            fmt_helper::pad6(static_cast<size_t>(fmt_helper::time_fraction<microseconds>(msg.time).count()), dest);
+            break;
+        case time_span::field::nanos:
+            fmt_helper::pad9(static_cast<size_t>(fmt_helper::time_fraction<nanoseconds>(msg.time).count()), dest);
+            break;
+        }
+        pos = f.offset + time_field_width(f.kind);
+    }
+    dest.append(span.text.data() + pos, span.text.data() + span.text.size());
+}
+
+// render the fields of a second (all but the fractions) into span.cached_text:
+// the whole date and time is converted at once, then each field copies its digits.
+// return false if one doesn't fit its width (e.g. year 12345).
+static bool render_time_span_seconds(time_span &span, const std::tm &tm_time)
+{
+    // "YYYYMMDD00hhmmss"
+    char digits[16];
+    if (!fmt_helper::write_tm_digits(digits, tm_time))
+    {
+        return false;
+    }
+    span.cached_text = span.text;
+    char *out = &span.cached_text[0];
+    for (auto &f : span.fields)
+    {
+        const char *value;
+        switch (f.kind)
+        {
+        case time_span::field::year:
+            if (digits[0] == '0') // below 1000: not padded by %Y
+            {
+                return false;
+            }
+            std::memcpy(out + f.offset, digits, 4);
+            continue;
+        case time_span::field::ampm:
+            out[f.offset] = tm_time.tm_hour >= 12 ? 'P' : 'A';
+            out[f.offset + 1] = 'M';
+            continue;
+        case time_span::field::year2:
+            if (tm_time.tm_year < 0) // tm_year % 100 is negative
+            {
+                return false;
+            }
+            value = digits + 2;
+            break;
+        case time_span::field::month:
+            value = digits + 4;
+            break;
+        case time_span::field::day:
+            value = digits + 6;
+            break;
+        case time_span::field::hour:
+            value = digits + 10;
+            break;
+        case time_span::field::hour12:
+            value = fmt_helper::digits3(static_cast<uint32_t>(to12h(tm_time))) + 1;
+            break;
+        case time_span::field::minute:
+            value = digits + 12;
+            break;
+        case time_span::field::second:
+            value = digits + 14;
+            break;
+        default: // fractions are patched per message
+            continue;
+        }
+        std::memcpy(out + f.offset, value, 2);
+    }
+    return true;
+}
+
+// append the text rendered for this second, then patch the fractions with the 000-999 table
+static void format_time_span(time_span &span, const log_msg &msg, const std::tm &tm_time, memory_buf_t &dest)
+{
+    auto duration = msg.time.time_since_epoch();
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(duration);
+    if (!span.cached || secs != span.cached_secs)
+    {
+        span.cached = render_time_span_seconds(span, tm_time);
+        span.cached_secs = secs;
+        if (!span.cached)
+        {
+            format_time_span_slow(span, msg, tm_time, dest);
+            return;
+        }
+    }
+
+    const size_t start = dest.size();
+    dest.append(span.cached_text.data(), span.cached_text.data() + span.cached_text.size());
+    if (span.fractions.empty())
+    {
+        return;
+    }
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration - secs).count();
+    if (ns < 0) // before the epoch
+    {
+        dest.resize(start);
+        format_time_span_slow(span, msg, tm_time, dest);
+        return;
+    }
+    auto nanos = static_cast<uint32_t>(ns);
+    char *out = dest.data() + start;
+    for (auto &f : span.fractions)
+    {
+        char *digits = out + f.offset;
+        switch (f.kind)
+        {
+        case time_span::field::millis:
+            std::memcpy(digits, fmt_helper::digits3(nanos / 1000000), 3);
+            break;
+        case time_span::field::micros:
+            std::memcpy(digits, fmt_helper::digits3(nanos / 1000000), 3);
+            std::memcpy(digits + 3, fmt_helper::digits3(nanos / 1000 % 1000), 3);
+            break;
+        default: // nanos
+            digits[0] = static_cast<char>('0' + nanos / 100000000);
+            fmt_helper::write_digits8(digits + 1, nanos % 100000000);
+            break;
+        }
+    }
+}
+
 } // namespace details
 
 SPDLOG_INLINE pattern_formatter::pattern_formatter(
@@ -1042,6 +1242,7 @@ SPDLOG_INLINE pattern_formatter::pattern_formatter(pattern_time_type time_type,
 {
     std::memset(&cached_tm_, 0, sizeof(cached_tm_));
     formatters_.push_back(details::make_unique<details::full_formatter>(details::padding_info{}));
+    add_op_(details::pattern_opcode::call, 0);
 }
 
 SPDLOG_INLINE std::unique_ptr<formatter> pattern_formatter::clone() const
@@ -1054,6 +1255,33 @@ SPDLOG_INLINE std::unique_ptr<formatter> pattern_formatter::clone() const
     return details::make_unique<pattern_formatter>(pattern_, pattern_time_type_, eol_, std::move(cloned_custom_formatters));
 }
 
+SPDLOG_INLINE std::string pattern_formatter::identity() const
+{
+    std::string result = pattern_;
+    result += '\0';
+    result += pattern_time_type_ == pattern_time_type::local ? 'l' : 'u';
+    result += eol_;
+    // custom flags in a fixed order, each must tell its identity
+    std::vector<char> flags;
+    for (auto &it : custom_handlers_)
+    {
+        flags.push_back(it.first);
+    }
+    std::sort(flags.begin(), flags.end());
+    for (char flag : flags)
+    {
+        auto flag_identity = custom_handlers_.at(flag)->identity();
+        if (flag_identity.empty())
+        {
+            return std::string();
+        }
+        result += '\0';
+        result += flag;
+        result += flag_identity;
+    }
+    return result;
+}
+
 SPDLOG_INLINE void pattern_formatter::format(const details::log_msg &msg, memory_buf_t &dest)
 {
     if (need_localtime_)
@@ -1066,9 +1294,41 @@ SPDLOG_INLINE void pattern_formatter::format(const details::log_msg &msg, memory
         }
     }
 
-    for (auto &f : formatters_)
+    for (auto &op : ops_)
     {
-        f->format(msg, cached_tm_, dest);
+        switch (op.code)
+        {
+        case details::pattern_opcode::literal:
+            dest.append(literals_.data() + op.index, literals_.data() + op.index + op.size);
+            break;
+        case details::pattern_opcode::time_span:
+            details::format_time_span(time_spans_[op.index], msg, cached_tm_, dest);
+            break;
+        case details::pattern_opcode::logger_name:
+            details::fmt_helper::append_string_view(msg.logger_name, dest);
+            break;
+        case details::pattern_opcode::level:
+            details::fmt_helper::append_string_view(level::to_string_view(msg.level), dest);
+            break;
+        case details::pattern_opcode::short_level:
+            details::fmt_helper::append_string_view(level::to_short_c_str(msg.level), dest);
+            break;
+        case details::pattern_opcode::thread_id:
+            details::fmt_helper::append_int(msg.thread_id, dest);
+            break;
+        case details::pattern_opcode::payload:
+            details::fmt_helper::append_string_view(msg.payload, dest);
+            break;
+        case details::pattern_opcode::color_start:
+            msg.color_range_start = dest.size();
+            break;
+        case details::pattern_opcode::color_stop:
+            msg.color_range_end = dest.size();
+            break;
+        case details::pattern_opcode::call:
+            formatters_[op.index]->format(msg, cached_tm_, dest);
+            break;
+        }
     }
     // write eol
     details::fmt_helper::append_string_view(eol_, dest);
@@ -1379,47 +1639,204 @@ SPDLOG_INLINE details::padding_info pattern_formatter::handle_padspec_(std::stri
 SPDLOG_INLINE void pattern_formatter::compile_pattern_(const std::string &pattern)
 {
     auto end = pattern.end();
-    std::unique_ptr<details::aggregate_formatter> user_chars;
+    details::time_span run;
     formatters_.clear();
+    ops_.clear();
+    literals_.clear();
+    time_spans_.clear();
     for (auto it = pattern.begin(); it != end; ++it)
     {
         if (*it == '%')
         {
-            if (user_chars) // append user chars found so far
+            auto padding = handle_padspec_(++it, end);
+
+            if (it == end)
             {
-                formatters_.push_back(std::move(user_chars));
+                break;
             }
 
-            auto padding = handle_padspec_(++it, end);
-
-            if (it != end)
+            // unpadded built-in flags get their own op (custom flags override them)
+            if (!padding.enabled() && custom_handlers_.find(*it) == custom_handlers_.end())
             {
-                if (padding.enabled())
+                if (*it == '%')
+                {
+                    run.text.push_back('%');
+                    continue;
+                }
+                if (add_time_flag_(*it, run))
                 {
-                    handle_flag_<details::scoped_padder>(*it, padding);
+                    continue;
                 }
-                else
+                bool native = true;
+                auto code = details::pattern_opcode::call;
+                switch (*it)
                 {
-                    handle_flag_<details::null_scoped_padder>(*it, padding);
+                case 'n':
+                    code = details::pattern_opcode::logger_name;
+                    break;
+                case 'l':
+                    code = details::pattern_opcode::level;
+                    break;
+                case 'L':
+                    code = details::pattern_opcode::short_level;
+                    break;
+                case 't':
+                    code = details::pattern_opcode::thread_id;
+                    break;
+                case 'v':
+                    code = details::pattern_opcode::payload;
+                    break;
+                case '^':
+                    code = details::pattern_opcode::color_start;
+                    break;
+                case '$':
+                    code = details::pattern_opcode::color_stop;
+                    break;
+                default:
+                    native = false;
+                    break;
                 }
+                if (native)
+                {
+                    flush_run_(run);
+                    add_op_(code);
+                    continue;
+                }
+            }
+
+            // everything else is called through its flag_formatter
+            flush_run_(run);
+            auto first = formatters_.size();
+            if (padding.enabled())
+            {
+                handle_flag_<details::scoped_padder>(*it, padding);
             }
             else
             {
-                break;
+                handle_flag_<details::null_scoped_padder>(*it, padding);
+            }
+            for (auto i = first; i < formatters_.size(); i++)
+            {
+                add_op_(details::pattern_opcode::call, i);
             }
         }
         else // chars not following the % sign should be displayed as is
         {
-            if (!user_chars)
-            {
-                user_chars = details::make_unique<details::aggregate_formatter>();
-            }
-            user_chars->add_ch(*it);
+            run.text.push_back(*it);
+        }
+    }
+    flush_run_(run);
+}
+
+SPDLOG_INLINE bool pattern_formatter::add_time_flag_(char flag, details::time_span &run)
+{
+    using field = details::time_span::field;
+    auto add = [&run](field kind) {
+        details::time_span::slot slot{kind, static_cast<uint32_t>(run.text.size())};
+        run.fields.push_back(slot);
+        if (kind == field::millis || kind == field::micros || kind == field::nanos)
+        {
+            run.fractions.push_back(slot);
         }
+        run.text.append(details::time_field_width(kind), '0');
+    };
+
+    switch (flag)
+    {
+    case 'e':
+        add(field::millis);
+        return true; // the fractions don't need the broken down time
+    case 'f':
+        add(field::micros);
+        return true;
+    case 'F':
+        add(field::nanos);
+        return true;
+    case 'Y':
+        add(field::year);
+        break;
+    case 'C':
+        add(field::year2);
+        break;
+    case 'm':
+        add(field::month);
+        break;
+    case 'd':
+        add(field::day);
+        break;
+    case 'H':
+        add(field::hour);
+        break;
+    case 'I':
+        add(field::hour12);
+        break;
+    case 'M':
+        add(field::minute);
+        break;
+    case 'S':
+        add(field::second);
+        break;
+    case 'p':
+        add(field::ampm);
+        break;
+    case 'D':
+    case 'x': // MM/DD/YY
+        add(field::month);
+        run.text.push_back('/');
+        add(field::day);
+        run.text.push_back('/');
+        add(field::year2);
+        break;
+    case 'R': // HH:MM
+        add(field::hour);
+        run.text.push_back(':');
+        add(field::minute);
+        break;
+    case 'T':
+    case 'X': // HH:MM:SS
+        add(field::hour);
+        run.text.push_back(':');
+        add(field::minute);
+        run.text.push_back(':');
+        add(field::second);
+        break;
+    case 'r': // 02:55:02 PM
+        add(field::hour12);
+        run.text.push_back(':');
+        add(field::minute);
+        run.text.push_back(':');
+        add(field::second);
+        run.text.push_back(' ');
+        add(field::ampm);
+        break;
+    default:
+        return false;
     }
-    if (user_chars) // append raw chars found so far
+    need_localtime_ = true;
+    return true;
+}
+
+SPDLOG_INLINE void pattern_formatter::flush_run_(details::time_span &run)
+{
+    if (run.text.empty())
     {
-        formatters_.push_back(std::move(user_chars));
+        return;
     }
+    if (run.fields.empty())
+    {
+        add_op_(details::pattern_opcode::literal, literals_.size(), run.text.size());
+        literals_ += run.text;
+    }
+    else
+    {
+        add_op_(details::pattern_opcode::time_span, time_spans_.size());
+        time_spans_.push_back(std::move(run));
+    }
+    run = details::time_span{};
+}
+
+SPDLOG_INLINE void pattern_formatter::add_op_(details::pattern_opcode code, size_t index, size_t size)
+{
+    ops_.push_back(details::pattern_op{code, static_cast<uint32_t>(index), static_cast<uint32_t>(size)});
 }
 } // namespace spdlog
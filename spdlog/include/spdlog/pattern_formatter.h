@@ -9,6 +9,7 @@
 #include <spdlog/formatter.h>
 
 #include <chrono>
+#include <cstdint>
 #include <ctime>
 #include <memory>
 
@@ -61,12 +62,80 @@ protected:
     padding_info padinfo_;
 };
 
+// compiled pattern: a flat list of ops run by a switch in pattern_formatter::format().
+// literal chars and unpadded fixed width time fields are merged into single ops, virtual
+// flag_formatters are only called for custom, padded and the less common flags.
+enum class pattern_opcode : uint8_t
+{
+    literal,     // literals[index, index + size)
+    time_span,   // time_spans[index]
+    logger_name, // %n
+    level,       // %l
+    short_level, // %L
+    thread_id,   // %t
+    payload,     // %v
+    color_start, // %^
+    color_stop,  // %$
+    call         // formatters[index]
+};
+
+struct pattern_op
+{
+    pattern_opcode code;
+    uint32_t index;
+    uint32_t size;
+};
+
+// a run of fixed width time fields and the chars around them, e.g. "[%H:%M:%S.%e] ["
+// the span is rendered once per second into `cached_text` (literal chars already in place in `text`),
+// then each message appends it and patches in the fractions of a second.
+struct time_span
+{
+    enum class field : uint8_t
+    {
+        year,   // %Y
+        year2,  // %C
+        month,  // %m
+        day,    // %d
+        hour,   // %H
+        hour12, // %I
+        minute, // %M
+        second, // %S
+        ampm,   // %p
+        millis, // %e
+        micros, // %f
+        nanos   // %F
+    };
+
+    struct slot
+    {
+        field kind;
+        uint32_t offset;
+    };
+
+    std::string text;
+    // all the fields, in order
+    std::vector<slot> fields;
+    // the fields below a second (%e %f %F), patched per message
+    std::vector<slot> fractions;
+
+    std::string cached_text;
+    std::chrono::seconds cached_secs{0};
+    bool cached = false;
+};
+
 } // namespace details
 
 class SPDLOG_API custom_flag_formatter : public details::flag_formatter
 {
 public:
     virtual std::unique_ptr<custom_flag_formatter> clone() const = 0;
+    // the same non empty identity means the same output (see formatter::identity()).
+    // default: empty, the pattern formatters using this flag are never shared.
+    virtual std::string identity() const
+    {
+        return std::string();
+    }
 
     void set_padding_info(const details::padding_info &padding)
     {
@@ -90,6 +159,7 @@ public:
 
     std::unique_ptr<formatter> clone() const override;
     void format(const details::log_msg &msg, memory_buf_t &dest) override;
+    std::string identity() const override;
 
     template<typename T, typename... Args>
     pattern_formatter &add_flag(char flag, Args &&... args)
@@ -107,6 +177,9 @@ private:
     std::tm cached_tm_;
     std::chrono::seconds last_log_secs_;
     std::vector<std::unique_ptr<details::flag_formatter>> formatters_;
+    std::vector<details::pattern_op> ops_;
+    std::string literals_;
+    std::vector<details::time_span> time_spans_;
     custom_flags custom_handlers_;
 
     std::tm get_time_(const details::log_msg &msg);
@@ -119,6 +192,12 @@ private:
     static details::padding_info handle_padspec_(std::string::const_iterator &it, std::string::const_iterator end);
 
     void compile_pattern_(const std::string &pattern);
+
+    // add the flag to the run of literal chars and time fields, if it is an unpadded fixed width time field
+    bool add_time_flag_(char flag, details::time_span &run);
+    // emit the run as a literal or time_span op and start a new one
+    void flush_run_(details::time_span &run);
+    void add_op_(details::pattern_opcode code, size_t index = 0, size_t size = 0);
 };
 } // namespace spdlog
 
@@ -20,6 +20,7 @@ SPDLOG_INLINE ansicolor_sink<ConsoleMutex>::ansicolor_sink(FILE *target_file, co
     , formatter_(details::make_unique<spdlog::pattern_formatter>())
 
 {
+    formatter_id_ = formatter_id_of(formatter_.get());
     set_color_mode(mode);
     colors_[level::trace] = to_string_(white);
     colors_[level::debug] = to_string_(cyan);
@@ -43,33 +44,57 @@ SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::log(const details::log_msg &msg
     // Wrap the originally formatted message in color codes.
     // If color is not supported in the terminal, log as is instead.
     std::lock_guard<mutex_t> lock(mutex_);
-    msg.color_range_start = 0;
-    msg.color_range_end = 0;
-    memory_buf_t formatted;
-    formatter_->format(msg, formatted);
-    if (should_do_colors_ && msg.color_range_end > msg.color_range_start)
+    format_and_print_(msg);
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE size_t ansicolor_sink<ConsoleMutex>::formatter_id() const
+{
+    return formatter_id_.load(std::memory_order_relaxed);
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE size_t ansicolor_sink<ConsoleMutex>::format(const details::log_msg &msg, memory_buf_t &dest)
+{
+    std::lock_guard<mutex_t> lock(mutex_);
+    formatter_->format(msg, dest);
+    return formatter_id_.load(std::memory_order_relaxed);
+}
+
+// the color range of msg is the one set when it was formatted
+template<typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::log_formatted(
+    const details::log_msg &msg, size_t formatter_id, string_view_t formatted)
+{
+    std::lock_guard<mutex_t> lock(mutex_);
+    // the formatter may have been replaced since the message was formatted
+    if (formatter_id != 0 && formatter_id == formatter_id_.load(std::memory_order_relaxed))
     {
-        // before color range
-        print_range_(formatted, 0, msg.color_range_start);
-        // in color range
-        print_ccode_(colors_[static_cast<size_t>(msg.level)]);
-        print_range_(formatted, msg.color_range_start, msg.color_range_end);
-        print_ccode_(reset);
-        // after color range
-        print_range_(formatted, msg.color_range_end, formatted.size());
+        print_formatted_(msg, formatted);
     }
-    else // no color
+    else
     {
-        print_range_(formatted, 0, formatted.size());
+        format_and_print_(msg);
     }
-    fflush(target_file_);
 }
 
 template<typename ConsoleMutex>
 SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::flush()
 {
     std::lock_guard<mutex_t> lock(mutex_);
-    fflush(target_file_);
+    counters_.timed_flush([this] { fflush(target_file_); });
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE details::sink_stats ansicolor_sink<ConsoleMutex>::stats() const
+{
+    return counters_.snapshot();
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE std::FILE *ansicolor_sink<ConsoleMutex>::stream_unsafe() const
+{
+    return target_file_;
 }
 
 template<typename ConsoleMutex>
@@ -77,12 +102,14 @@ SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::set_pattern(const std::string &
 {
     std::lock_guard<mutex_t> lock(mutex_);
     formatter_ = std::unique_ptr<spdlog::formatter>(new pattern_formatter(pattern));
+    formatter_id_ = formatter_id_of(formatter_.get());
 }
 
 template<typename ConsoleMutex>
 SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter)
 {
     std::lock_guard<mutex_t> lock(mutex_);
+    formatter_id_ = formatter_id_of(sink_formatter.get());
     formatter_ = std::move(sink_formatter);
 }
 
@@ -115,12 +142,48 @@ template<typename ConsoleMutex>
 SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::print_ccode_(const string_view_t &color_code)
 {
     fwrite(color_code.data(), sizeof(char), color_code.size(), target_file_);
+    counters_.on_write(color_code.size());
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::format_and_print_(const details::log_msg &msg)
+{
+    msg.color_range_start = 0;
+    msg.color_range_end = 0;
+    memory_buf_t formatted;
+    formatter_->format(msg, formatted);
+    print_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::print_formatted_(const details::log_msg &msg, string_view_t formatted)
+{
+    if (should_do_colors_ && msg.color_range_end > msg.color_range_start)
+    {
+        // before color range
+        print_range_(formatted, 0, msg.color_range_start);
+        // in color range
+        print_ccode_(colors_[static_cast<size_t>(msg.level)]);
+        print_range_(formatted, msg.color_range_start, msg.color_range_end);
+        print_ccode_(reset);
+        // after color range
+        print_range_(formatted, msg.color_range_end, formatted.size());
+    }
+    else // no color
+    {
+        print_range_(formatted, 0, formatted.size());
+    }
+    fflush(target_file_);
 }
 
 template<typename ConsoleMutex>
-SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::print_range_(const memory_buf_t &formatted, size_t start, size_t end)
+SPDLOG_INLINE void ansicolor_sink<ConsoleMutex>::print_range_(string_view_t formatted, size_t start, size_t end)
 {
-    fwrite(formatted.data() + start, sizeof(char), end - start, target_file_);
+    if (end > start)
+    {
+        fwrite(formatted.data() + start, sizeof(char), end - start, target_file_);
+        counters_.on_write(end - start);
+    }
 }
 
 template<typename ConsoleMutex>
@@ -10,6 +10,7 @@
 #include <mutex>
 #include <string>
 #include <array>
+#include <atomic>
 
 namespace spdlog {
 namespace sinks {
@@ -43,6 +44,11 @@ public:
     void flush() override;
     void set_pattern(const std::string &pattern) final;
     void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+    details::sink_stats stats() const override;
+    std::FILE *stream_unsafe() const override;
+    size_t formatter_id() const override;
+    size_t format(const details::log_msg &msg, memory_buf_t &dest) override;
+    void log_formatted(const details::log_msg &msg, size_t formatter_id, string_view_t formatted) override;
 
     // Formatting codes
     const string_view_t reset = "\033[m";
@@ -84,9 +90,14 @@ private:
     mutex_t &mutex_;
     bool should_do_colors_;
     std::unique_ptr<spdlog::formatter> formatter_;
+    std::atomic<size_t> formatter_id_{0};
     std::array<std::string, level::n_levels> colors_;
+    details::sink_counters counters_;
+    void format_and_print_(const details::log_msg &msg);
+    // write the formatted message, its color range in color
+    void print_formatted_(const details::log_msg &msg, string_view_t formatted);
     void print_ccode_(const string_view_t &color_code);
-    void print_range_(const memory_buf_t &formatted, size_t start, size_t end);
+    void print_range_(string_view_t formatted, size_t start, size_t end);
     static std::string to_string_(const string_view_t &sv);
 };
 
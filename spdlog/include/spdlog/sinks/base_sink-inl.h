@@ -15,12 +15,16 @@
 template<typename Mutex>
 SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::base_sink()
     : formatter_{details::make_unique<spdlog::pattern_formatter>()}
-{}
+{
+    formatter_id_ = formatter_id_of(formatter_.get());
+}
 
 template<typename Mutex>
 SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::base_sink(std::unique_ptr<spdlog::formatter> formatter)
     : formatter_{std::move(formatter)}
-{}
+{
+    formatter_id_ = formatter_id_of(formatter_.get());
+}
 
 template<typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log(const details::log_msg &msg)
@@ -29,11 +33,78 @@ void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log(const details::log_msg &
     sink_it_(msg);
 }
 
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_batch(const details::log_msg *const *msgs, size_t count)
+{
+    std::lock_guard<Mutex> lock(mutex_);
+    sink_batch_(msgs, count);
+}
+
 template<typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::flush()
 {
     std::lock_guard<Mutex> lock(mutex_);
-    flush_();
+    counters_.timed_flush([this] { flush_(); });
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sync()
+{
+    std::lock_guard<Mutex> lock(mutex_);
+    counters_.timed_flush([this] { flush_(); });
+    sync_();
+}
+
+template<typename Mutex>
+spdlog::details::sink_stats SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::stats() const
+{
+    return counters_.snapshot();
+}
+
+template<typename Mutex>
+size_t SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::formatter_id() const
+{
+    return formatter_id_.load(std::memory_order_relaxed);
+}
+
+template<typename Mutex>
+size_t SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::format(const details::log_msg &msg, memory_buf_t &dest)
+{
+    std::lock_guard<Mutex> lock(mutex_);
+    formatter_->format(msg, dest);
+    return formatter_id_.load(std::memory_order_relaxed);
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_formatted(
+    const details::log_msg &msg, size_t formatter_id, string_view_t formatted)
+{
+    std::lock_guard<Mutex> lock(mutex_);
+    // the formatter may have been replaced since the message was formatted
+    if (formatter_id != 0 && formatter_id == formatter_id_.load(std::memory_order_relaxed))
+    {
+        sink_formatted_(msg, formatted);
+    }
+    else
+    {
+        sink_it_(msg);
+    }
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::log_batch_formatted(
+    const details::log_msg *const *msgs, const string_view_t *formatted, size_t count, size_t formatter_id)
+{
+    std::lock_guard<Mutex> lock(mutex_);
+    // the formatter may have been replaced since the messages were formatted
+    if (formatter_id != 0 && formatter_id == formatter_id_.load(std::memory_order_relaxed))
+    {
+        sink_batch_formatted_(msgs, formatted, count);
+    }
+    else
+    {
+        sink_batch_(msgs, count);
+    }
 }
 
 template<typename Mutex>
@@ -59,5 +130,41 @@ void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_pattern_(const std::stri
 template<typename Mutex>
 void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter)
 {
+    formatter_id_ = formatter_id_of(sink_formatter.get());
     formatter_ = std::move(sink_formatter);
 }
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sync_()
+{}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_formatted_(const details::log_msg &msg, string_view_t)
+{
+    sink_it_(msg);
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_batch_(const details::log_msg *const *msgs, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (should_log(msgs[i]->level))
+        {
+            sink_it_(*msgs[i]);
+        }
+    }
+}
+
+template<typename Mutex>
+void SPDLOG_INLINE spdlog::sinks::base_sink<Mutex>::sink_batch_formatted_(
+    const details::log_msg *const *msgs, const string_view_t *formatted, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (should_log(msgs[i]->level))
+        {
+            sink_formatted_(*msgs[i], formatted[i]);
+        }
+    }
+}
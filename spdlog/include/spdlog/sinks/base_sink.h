@@ -13,6 +13,8 @@
 #include <spdlog/details/log_msg.h>
 #include <spdlog/sinks/sink.h>
 
+#include <atomic>
+
 namespace spdlog {
 namespace sinks {
 template<typename Mutex>
@@ -30,17 +32,38 @@ public:
     base_sink &operator=(base_sink &&) = delete;
 
     void log(const details::log_msg &msg) final;
+    void log_batch(const details::log_msg *const *msgs, size_t count) final;
     void flush() final;
+    void sync() final;
     void set_pattern(const std::string &pattern) final;
     void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) final;
+    details::sink_stats stats() const final;
+    size_t formatter_id() const override;
+    size_t format(const details::log_msg &msg, memory_buf_t &dest) final;
+    void log_formatted(const details::log_msg &msg, size_t formatter_id, string_view_t formatted) final;
+    void log_batch_formatted(const details::log_msg *const *msgs, const string_view_t *formatted, size_t count, size_t formatter_id) final;
 
 protected:
     // sink formatter
     std::unique_ptr<spdlog::formatter> formatter_;
     Mutex mutex_;
+    // updated with the mutex held: implementers report their writes (flushes are timed here)
+    details::sink_counters counters_;
+    // id of formatter_ (see sink::formatter_id()), updated by set_formatter_()
+    std::atomic<size_t> formatter_id_{0};
 
     virtual void sink_it_(const details::log_msg &msg) = 0;
+    // called with the mutex held by log_formatted() when the formatted bytes come from a formatter
+    // like formatter_. default: sink_it_() (formats again).
+    virtual void sink_formatted_(const details::log_msg &msg, string_view_t formatted);
+    // called with the mutex held once per batch. default: sink_it_() per message that passes the sink level.
+    virtual void sink_batch_(const details::log_msg *const *msgs, size_t count);
+    // called with the mutex held once per batch by log_batch_formatted() when the formatted bytes come
+    // from a formatter like formatter_. default: sink_formatted_() per message that passes the sink level.
+    virtual void sink_batch_formatted_(const details::log_msg *const *msgs, const string_view_t *formatted, size_t count);
     virtual void flush_() = 0;
+    // called with the mutex held after flush_() by sync(). default: nothing (no file to sync).
+    virtual void sync_();
     virtual void set_pattern_(const std::string &pattern);
     virtual void set_formatter_(std::unique_ptr<spdlog::formatter> sink_formatter);
 };
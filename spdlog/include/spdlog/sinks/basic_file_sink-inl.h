@@ -26,12 +26,64 @@ SPDLOG_INLINE const filename_t &basic_file_sink<Mutex>::filename() const
     return file_helper_.filename();
 }
 
+template<typename Mutex>
+SPDLOG_INLINE std::FILE *basic_file_sink<Mutex>::stream_unsafe() const
+{
+    return file_helper_.stream();
+}
+
 template<typename Mutex>
 SPDLOG_INLINE void basic_file_sink<Mutex>::sink_it_(const details::log_msg &msg)
 {
     memory_buf_t formatted;
     base_sink<Mutex>::formatter_->format(msg, formatted);
+    sink_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_formatted_(const details::log_msg &, string_view_t formatted)
+{
     file_helper_.write(formatted);
+    base_sink<Mutex>::counters_.on_write(formatted.size());
+}
+
+// format the whole batch into one buffer and write it at once
+template<typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_batch_(const details::log_msg *const *msgs, size_t count)
+{
+    memory_buf_t formatted;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (base_sink<Mutex>::should_log(msgs[i]->level))
+        {
+            base_sink<Mutex>::formatter_->format(*msgs[i], formatted);
+        }
+    }
+    if (formatted.size() > 0)
+    {
+        file_helper_.write(formatted);
+        base_sink<Mutex>::counters_.on_write(formatted.size());
+    }
+}
+
+// gather the batch into one buffer and write it at once
+template<typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sink_batch_formatted_(
+    const details::log_msg *const *msgs, const string_view_t *formatted, size_t count)
+{
+    memory_buf_t batch;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (base_sink<Mutex>::should_log(msgs[i]->level))
+        {
+            batch.append(formatted[i].data(), formatted[i].data() + formatted[i].size());
+        }
+    }
+    if (batch.size() > 0)
+    {
+        file_helper_.write(batch);
+        base_sink<Mutex>::counters_.on_write(batch.size());
+    }
 }
 
 template<typename Mutex>
@@ -40,5 +92,11 @@ SPDLOG_INLINE void basic_file_sink<Mutex>::flush_()
     file_helper_.flush();
 }
 
+template<typename Mutex>
+SPDLOG_INLINE void basic_file_sink<Mutex>::sync_()
+{
+    file_helper_.sync();
+}
+
 } // namespace sinks
 } // namespace spdlog
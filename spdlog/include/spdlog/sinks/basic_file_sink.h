@@ -22,10 +22,15 @@ class basic_file_sink final : public base_sink<Mutex>
 public:
     explicit basic_file_sink(const filename_t &filename, bool truncate = false, const file_event_handlers &event_handlers = {});
     const filename_t &filename() const;
+    std::FILE *stream_unsafe() const override;
 
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override;
+    void sink_batch_(const details::log_msg *const *msgs, size_t count) override;
+    void sink_batch_formatted_(const details::log_msg *const *msgs, const string_view_t *formatted, size_t count) override;
     void flush_() override;
+    void sync_() override;
 
 private:
     details::file_helper file_helper_;
@@ -0,0 +1,256 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+//
+// Lock free ring buffer sink (always-on in-memory trace buffer).
+// Unlike ringbuffer_sink, log() takes no lock and never allocates: each message gets the
+// next cell of a fixed array (fetch_add) and is copied into it, the payload truncated to
+// max_payload bytes. Each cell has a sequence number (odd while written, 2 * pos + 2 once
+// message number pos is complete), so readers copy a snapshot of the cells seqlock style,
+// skip the ones being rewritten and never stall the writers. The cells are written and read
+// through relaxed atomics (the bytes one 64 bit word at a time), so a reader copying a cell
+// that is being rewritten is no data race, it just throws the copy away.
+// A writer lapped by the whole ring while another one is still copying into the same cell
+// drops its message instead of waiting (see dropped()).
+// The messages are formatted when read, under a mutex only readers and set_pattern take.
+//
+
+#include "spdlog/sinks/sink.h"
+#include "spdlog/details/log_msg_buffer.h"
+#include "spdlog/pattern_formatter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace spdlog {
+namespace sinks {
+
+class concurrent_ringbuffer_sink final : public sink
+{
+public:
+    static const size_t max_logger_name = 31;
+
+    // n_items is rounded up to a power of 2
+    explicit concurrent_ringbuffer_sink(size_t n_items, size_t max_payload = 256)
+        : capacity_(round_up_pow2_(n_items))
+        , mask_(capacity_ - 1)
+        , max_payload_(max_payload)
+        , payload_words_(words_(max_payload))
+        , cells_(new cell[capacity_])
+        , payloads_(new std::atomic<uint64_t>[capacity_ * payload_words_])
+        , formatter_(details::make_unique<spdlog::pattern_formatter>())
+    {
+        for (size_t i = 0; i < capacity_; i++)
+        {
+            cells_[i].sequence.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    concurrent_ringbuffer_sink(const concurrent_ringbuffer_sink &) = delete;
+    concurrent_ringbuffer_sink &operator=(const concurrent_ringbuffer_sink &) = delete;
+
+    void log(const details::log_msg &msg) override
+    {
+        uint64_t pos = write_pos_.fetch_add(1, std::memory_order_relaxed);
+        cell &c = cells_[pos & mask_];
+        uint64_t seq = c.sequence.load(std::memory_order_relaxed);
+        // claim the cell, unless a writer is still copying into it or it already holds a newer message
+        if ((seq & 1) != 0 || seq > 2 * pos ||
+            !c.sequence.compare_exchange_strong(seq, 2 * pos + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // readers must see the odd sequence before any of the new data
+        std::atomic_thread_fence(std::memory_order_release);
+
+        c.time.store(msg.time.time_since_epoch().count(), std::memory_order_relaxed);
+        c.filename.store(msg.source.filename, std::memory_order_relaxed);
+        c.line.store(msg.source.line, std::memory_order_relaxed);
+        c.funcname.store(msg.source.funcname, std::memory_order_relaxed);
+        c.thread_id.store(msg.thread_id, std::memory_order_relaxed);
+        c.level.store(static_cast<int>(msg.level), std::memory_order_relaxed);
+        size_t logger_name_size = (std::min)(msg.logger_name.size(), static_cast<size_t>(max_logger_name));
+        c.logger_name_size.store(logger_name_size, std::memory_order_relaxed);
+        store_words_(c.logger_name, msg.logger_name.data(), logger_name_size);
+        size_t payload_size = (std::min)(msg.payload.size(), max_payload_);
+        c.payload_size.store(payload_size, std::memory_order_relaxed);
+        store_words_(payload_at_(pos), msg.payload.data(), payload_size);
+
+        c.sequence.store(2 * pos + 2, std::memory_order_release);
+    }
+
+    void flush() override {}
+
+    void set_pattern(const std::string &pattern) override
+    {
+        set_formatter(details::make_unique<spdlog::pattern_formatter>(pattern));
+    }
+
+    void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override
+    {
+        std::lock_guard<std::mutex> lock(formatter_mutex_);
+        formatter_ = std::move(sink_formatter);
+    }
+
+    // the last lim (0: all) messages, oldest first.
+    // messages being rewritten while reading are skipped, so fewer may be returned.
+    std::vector<details::log_msg_buffer> last_raw(size_t lim = 0) const
+    {
+        std::vector<details::log_msg_buffer> ret;
+        visit_snapshot_(lim, [&ret](const details::log_msg &msg) { ret.emplace_back(msg); });
+        return ret;
+    }
+
+    std::vector<std::string> last_formatted(size_t lim = 0) const
+    {
+        std::vector<std::string> ret;
+        std::lock_guard<std::mutex> lock(formatter_mutex_);
+        visit_snapshot_(lim, [this, &ret](const details::log_msg &msg) {
+            memory_buf_t formatted;
+            formatter_->format(msg, formatted);
+#ifdef SPDLOG_USE_STD_FORMAT
+            ret.push_back(std::move(formatted));
+#else
+            ret.push_back(fmt::to_string(formatted));
+#endif
+        });
+        return ret;
+    }
+
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    // messages given up because their cell was still being written
+    size_t dropped() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static const size_t cache_line_size = 64;
+
+    static size_t words_(size_t size)
+    {
+        return (size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    }
+
+    struct cell
+    {
+        std::atomic<uint64_t> sequence;
+        std::atomic<log_clock::rep> time;
+        std::atomic<const char *> filename;
+        std::atomic<int> line;
+        std::atomic<const char *> funcname;
+        std::atomic<size_t> thread_id;
+        std::atomic<int> level;
+        std::atomic<size_t> logger_name_size;
+        std::atomic<size_t> payload_size;
+        std::atomic<uint64_t> logger_name[(max_logger_name + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+    };
+
+    std::atomic<uint64_t> *payload_at_(uint64_t pos) const
+    {
+        return payloads_.get() + (pos & mask_) * payload_words_;
+    }
+
+    static void store_words_(std::atomic<uint64_t> *words, const char *src, size_t size)
+    {
+        for (size_t i = 0; i < size; i += sizeof(uint64_t))
+        {
+            uint64_t word = 0;
+            std::memcpy(&word, src + i, (std::min)(sizeof(uint64_t), size - i));
+            words[i / sizeof(uint64_t)].store(word, std::memory_order_relaxed);
+        }
+    }
+
+    static void load_words_(const std::atomic<uint64_t> *words, char *dest, size_t size)
+    {
+        for (size_t i = 0; i < size; i += sizeof(uint64_t))
+        {
+            uint64_t word = words[i / sizeof(uint64_t)].load(std::memory_order_relaxed);
+            std::memcpy(dest + i, &word, (std::min)(sizeof(uint64_t), size - i));
+        }
+    }
+
+    // copy out each complete message of the last lim, re-checking its sequence after the copy
+    template<typename Visitor>
+    void visit_snapshot_(size_t lim, Visitor &&visitor) const
+    {
+        uint64_t end = write_pos_.load(std::memory_order_acquire);
+        uint64_t n_items = (std::min)(end, static_cast<uint64_t>(capacity_));
+        if (lim > 0)
+        {
+            n_items = (std::min)(n_items, static_cast<uint64_t>(lim));
+        }
+
+        char logger_name[max_logger_name];
+        std::vector<char> payload(max_payload_);
+        for (uint64_t pos = end - n_items; pos < end; pos++)
+        {
+            const cell &c = cells_[pos & mask_];
+            uint64_t seq = c.sequence.load(std::memory_order_acquire);
+            if (seq != 2 * pos + 2)
+            {
+                continue;
+            }
+            details::log_msg msg;
+            msg.time = log_clock::time_point(log_clock::duration(c.time.load(std::memory_order_relaxed)));
+            msg.source = source_loc(c.filename.load(std::memory_order_relaxed), c.line.load(std::memory_order_relaxed),
+                c.funcname.load(std::memory_order_relaxed));
+            msg.thread_id = c.thread_id.load(std::memory_order_relaxed);
+            msg.level = static_cast<level::level_enum>(c.level.load(std::memory_order_relaxed));
+            size_t logger_name_size = (std::min)(c.logger_name_size.load(std::memory_order_relaxed), static_cast<size_t>(max_logger_name));
+            size_t payload_size = (std::min)(c.payload_size.load(std::memory_order_relaxed), max_payload_);
+            load_words_(c.logger_name, logger_name, logger_name_size);
+            load_words_(payload_at_(pos), payload.data(), payload_size);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (c.sequence.load(std::memory_order_relaxed) != seq)
+            {
+                continue;
+            }
+            msg.logger_name = string_view_t(logger_name, logger_name_size);
+            msg.payload = string_view_t(payload.data(), payload_size);
+            visitor(msg);
+        }
+    }
+
+    static size_t round_up_pow2_(size_t n)
+    {
+        size_t result = 2;
+        while (result < n)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    const size_t max_payload_;
+    const size_t payload_words_;
+    std::unique_ptr<cell[]> cells_;
+    std::unique_ptr<std::atomic<uint64_t>[]> payloads_;
+
+    // the writers' position lives on its own cache line
+    char pad0_[cache_line_size];
+    std::atomic<uint64_t> write_pos_{0};
+    char pad1_[cache_line_size - sizeof(std::atomic<uint64_t>)];
+    std::atomic<size_t> dropped_{0};
+
+    mutable std::mutex formatter_mutex_;
+    std::unique_ptr<spdlog::formatter> formatter_;
+};
+
+} // namespace sinks
+} // namespace spdlog
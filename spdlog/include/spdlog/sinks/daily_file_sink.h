@@ -148,8 +148,20 @@ public:
         return file_helper_.filename();
     }
 
+    std::FILE *stream_unsafe() const override
+    {
+        return file_helper_.stream();
+    }
+
 protected:
     void sink_it_(const details::log_msg &msg) override
+    {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+    }
+
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override
     {
         auto time = msg.time;
         bool should_rotate = time >= rotation_tp_;
@@ -159,9 +171,8 @@ protected:
             file_helper_.open(filename, truncate_);
             rotation_tp_ = next_rotation_tp_();
         }
-        memory_buf_t formatted;
-        base_sink<Mutex>::formatter_->format(msg, formatted);
         file_helper_.write(formatted);
+        base_sink<Mutex>::counters_.on_write(formatted.size());
 
         // Do the cleaning only at the end because it might throw on failure.
         if (should_rotate && max_files_ > 0)
@@ -170,11 +181,56 @@ protected:
         }
     }
 
+    // format the batch into one buffer, written at once (or when a rotation is due)
+    void sink_batch_(const details::log_msg *const *msgs, size_t count) override
+    {
+        memory_buf_t batch;
+        bool rotated = false;
+        for (size_t i = 0; i < count; i++)
+        {
+            const auto &msg = *msgs[i];
+            if (!base_sink<Mutex>::should_log(msg.level))
+            {
+                continue;
+            }
+            if (msg.time >= rotation_tp_)
+            {
+                if (batch.size() > 0)
+                {
+                    file_helper_.write(batch);
+                    base_sink<Mutex>::counters_.on_write(batch.size());
+                    batch.clear();
+                }
+                auto filename = FileNameCalc::calc_filename(base_filename_, now_tm(msg.time));
+                file_helper_.open(filename, truncate_);
+                rotation_tp_ = next_rotation_tp_();
+                rotated = true;
+            }
+            base_sink<Mutex>::formatter_->format(msg, batch);
+        }
+        if (batch.size() > 0)
+        {
+            file_helper_.write(batch);
+            base_sink<Mutex>::counters_.on_write(batch.size());
+        }
+
+        // Do the cleaning only at the end because it might throw on failure.
+        if (rotated && max_files_ > 0)
+        {
+            delete_old_();
+        }
+    }
+
     void flush_() override
     {
         file_helper_.flush();
     }
 
+    void sync_() override
+    {
+        file_helper_.sync();
+    }
+
 private:
     void init_filenames_q_()
     {
@@ -54,6 +54,12 @@ public:
         return sinks_;
     }
 
+    // the sinks format with their own formatters
+    size_t formatter_id() const override
+    {
+        return 0;
+    }
+
 protected:
     void sink_it_(const details::log_msg &msg) override
     {
@@ -74,6 +80,14 @@ protected:
         }
     }
 
+    void sync_() override
+    {
+        for (auto &sink : sinks_)
+        {
+            sink->sync();
+        }
+    }
+
     void set_pattern_(const std::string &pattern) override
     {
         set_formatter_(details::make_unique<spdlog::pattern_formatter>(pattern));
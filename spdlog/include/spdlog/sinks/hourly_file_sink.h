@@ -71,8 +71,20 @@ public:
         return file_helper_.filename();
     }
 
+    std::FILE *stream_unsafe() const override
+    {
+        return file_helper_.stream();
+    }
+
 protected:
     void sink_it_(const details::log_msg &msg) override
+    {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+    }
+
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override
     {
         auto time = msg.time;
         bool should_rotate = time >= rotation_tp_;
@@ -82,9 +94,8 @@ protected:
             file_helper_.open(filename, truncate_);
             rotation_tp_ = next_rotation_tp_();
         }
-        memory_buf_t formatted;
-        base_sink<Mutex>::formatter_->format(msg, formatted);
         file_helper_.write(formatted);
+        base_sink<Mutex>::counters_.on_write(formatted.size());
 
         // Do the cleaning only at the end because it might throw on failure.
         if (should_rotate && max_files_ > 0)
@@ -98,6 +109,11 @@ protected:
         file_helper_.flush();
     }
 
+    void sync_() override
+    {
+        file_helper_.sync();
+    }
+
 private:
     void init_filenames_q_()
     {
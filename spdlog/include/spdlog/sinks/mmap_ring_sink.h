@@ -0,0 +1,286 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+//
+// Memory mapped ring buffer sink ("flight recorder", POSIX only).
+// Formatted messages are copied back to back into a fixed size file mapped with MAP_SHARED:
+// a write is a memcpy and no system call. The pages belong to the kernel, so the last
+// `capacity` bytes of logs survive a crash of the process (use sync() to survive a crash
+// of the machine too). read_mmap_ring_file() decodes a ring file.
+//
+
+#include <spdlog/common.h>
+#include <spdlog/details/null_mutex.h>
+#include <spdlog/details/os.h>
+#include <spdlog/details/synchronous_factory.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace spdlog {
+namespace details {
+
+// ring file layout: this header, then `capacity` bytes of ring data.
+// write_pos counts all the bytes ever written: the ring holds [write_pos - min(write_pos, capacity), write_pos)
+// and a record is only counted once it is completely copied.
+struct mmap_ring_header
+{
+    static constexpr uint32_t current_version = 1;
+
+    char magic[8]; // "SPDRING"
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t capacity;
+    uint64_t write_pos;
+    // number of records written
+    uint64_t sequence;
+    char reserved[24];
+
+    static const char *expected_magic()
+    {
+        return "SPDRING";
+    }
+
+    bool valid(uint64_t expected_capacity) const
+    {
+        return std::memcmp(magic, expected_magic(), sizeof(magic)) == 0 && version == current_version &&
+               header_size == sizeof(mmap_ring_header) && capacity == expected_capacity;
+    }
+};
+static_assert(sizeof(mmap_ring_header) == 64, "mmap_ring_header must be 64 bytes");
+
+} // namespace details
+
+namespace sinks {
+
+template<typename Mutex>
+class mmap_ring_sink final : public base_sink<Mutex>
+{
+public:
+    // capacity: bytes of ring data (the file is 64 bytes larger).
+    // an existing ring file of the same capacity is appended to, unless truncate is set,
+    // so the records of a crashed run are kept until they are overwritten.
+    mmap_ring_sink(filename_t filename, size_t capacity, bool truncate = false)
+        : filename_(std::move(filename))
+        , capacity_(capacity)
+    {
+        if (capacity_ == 0)
+        {
+            throw_spdlog_ex("mmap_ring_sink: capacity must be > 0");
+        }
+        open_(truncate);
+    }
+
+    ~mmap_ring_sink() override
+    {
+        ::munmap(mapping_, sizeof(details::mmap_ring_header) + capacity_);
+        ::close(fd_);
+    }
+
+    mmap_ring_sink(const mmap_ring_sink &) = delete;
+    mmap_ring_sink &operator=(const mmap_ring_sink &) = delete;
+
+    const filename_t &filename() const
+    {
+        return filename_;
+    }
+
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+
+protected:
+    void sink_it_(const details::log_msg &msg) override
+    {
+        memory_buf_t formatted;
+        base_sink<Mutex>::formatter_->format(msg, formatted);
+        sink_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+    }
+
+    void sink_formatted_(const details::log_msg &, string_view_t formatted) override
+    {
+        write_(formatted.data(), formatted.size());
+        base_sink<Mutex>::counters_.on_write(formatted.size());
+    }
+
+    void sink_batch_(const details::log_msg *const *msgs, size_t count) override
+    {
+        memory_buf_t formatted;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!base_sink<Mutex>::should_log(msgs[i]->level))
+            {
+                continue;
+            }
+            formatted.clear();
+            base_sink<Mutex>::formatter_->format(*msgs[i], formatted);
+            write_(formatted.data(), formatted.size());
+            base_sink<Mutex>::counters_.on_write(formatted.size());
+        }
+    }
+
+    // the data is in the page cache already
+    void flush_() override {}
+
+    void sync_() override
+    {
+        if (::msync(mapping_, sizeof(details::mmap_ring_header) + capacity_, MS_SYNC) != 0)
+        {
+            throw_spdlog_ex("mmap_ring_sink: failed syncing " + filename_, errno);
+        }
+    }
+
+private:
+    void open_(bool truncate)
+    {
+        const size_t file_size = sizeof(details::mmap_ring_header) + capacity_;
+        details::os::create_dir(details::os::dir_name(filename_));
+        fd_ = ::open(filename_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0)
+        {
+            throw_spdlog_ex("mmap_ring_sink: failed opening " + filename_, errno);
+        }
+        struct stat st;
+        bool resize = ::fstat(fd_, &st) != 0 || static_cast<size_t>(st.st_size) != file_size;
+        if (resize || truncate)
+        {
+            // allocate the blocks now: writing to a page of a sparse file raises SIGBUS if the disk is full
+            bool allocated = ::ftruncate(fd_, 0) == 0 && ::ftruncate(fd_, static_cast<off_t>(file_size)) == 0;
+#ifdef __linux__
+            allocated = allocated && ::posix_fallocate(fd_, 0, static_cast<off_t>(file_size)) == 0;
+#endif
+            if (!allocated)
+            {
+                int err = errno;
+                ::close(fd_);
+                throw_spdlog_ex("mmap_ring_sink: failed allocating " + filename_, err);
+            }
+        }
+
+        void *mapping = ::mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (mapping == MAP_FAILED)
+        {
+            int err = errno;
+            ::close(fd_);
+            throw_spdlog_ex("mmap_ring_sink: failed mapping " + filename_, err);
+        }
+        mapping_ = static_cast<char *>(mapping);
+        header_ = reinterpret_cast<details::mmap_ring_header *>(mapping_);
+        data_ = mapping_ + sizeof(details::mmap_ring_header);
+
+        if (!header_->valid(capacity_))
+        {
+            std::memset(header_, 0, sizeof(details::mmap_ring_header));
+            std::memcpy(header_->magic, details::mmap_ring_header::expected_magic(), sizeof(header_->magic));
+            header_->version = details::mmap_ring_header::current_version;
+            header_->header_size = sizeof(details::mmap_ring_header);
+            header_->capacity = capacity_;
+        }
+    }
+
+    void write_(const char *data, size_t size)
+    {
+        // a record larger than the ring keeps its end (with the eol)
+        if (size > capacity_)
+        {
+            data += size - capacity_;
+            size = capacity_;
+        }
+        uint64_t pos = header_->write_pos;
+        size_t offset = static_cast<size_t>(pos % capacity_);
+        size_t first = (std::min)(size, capacity_ - offset);
+        std::memcpy(data_ + offset, data, first);
+        std::memcpy(data_, data + first, size - first);
+        // publish the record only once it is copied
+        std::atomic_thread_fence(std::memory_order_release);
+        header_->write_pos = pos + size;
+        header_->sequence++;
+    }
+
+    filename_t filename_;
+    size_t capacity_;
+    int fd_ = -1;
+    char *mapping_ = nullptr;
+    details::mmap_ring_header *header_ = nullptr;
+    char *data_ = nullptr;
+};
+
+using mmap_ring_sink_mt = mmap_ring_sink<std::mutex>;
+using mmap_ring_sink_st = mmap_ring_sink<details::null_mutex>;
+
+} // namespace sinks
+
+//
+// factory functions
+//
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> mmap_ring_logger_mt(
+    const std::string &logger_name, const filename_t &filename, size_t capacity, bool truncate = false)
+{
+    return Factory::template create<sinks::mmap_ring_sink_mt>(logger_name, filename, capacity, truncate);
+}
+
+template<typename Factory = spdlog::synchronous_factory>
+inline std::shared_ptr<logger> mmap_ring_logger_st(
+    const std::string &logger_name, const filename_t &filename, size_t capacity, bool truncate = false)
+{
+    return Factory::template create<sinks::mmap_ring_sink_st>(logger_name, filename, capacity, truncate);
+}
+
+// decode a ring file: the records it holds, oldest first. once the ring has wrapped,
+// the partly overwritten oldest record is skipped (up to the first eol).
+// throw spdlog_ex if the file can't be read or is not a ring file.
+inline std::string read_mmap_ring_file(const filename_t &filename, uint64_t *sequence = nullptr)
+{
+    std::FILE *file = std::fopen(filename.c_str(), "rb");
+    if (file == nullptr)
+    {
+        throw_spdlog_ex("read_mmap_ring_file: failed opening " + filename, errno);
+    }
+    details::mmap_ring_header header;
+    std::string ring;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 && header.valid(header.capacity) && header.capacity > 0;
+    if (ok)
+    {
+        ring.resize(static_cast<size_t>(header.capacity));
+        ok = std::fread(&ring[0], 1, ring.size(), file) == ring.size();
+    }
+    std::fclose(file);
+    if (!ok)
+    {
+        throw_spdlog_ex("read_mmap_ring_file: " + filename + " is not a valid ring file");
+    }
+    if (sequence != nullptr)
+    {
+        *sequence = header.sequence;
+    }
+
+    if (header.write_pos <= header.capacity)
+    {
+        ring.resize(static_cast<size_t>(header.write_pos));
+        return ring;
+    }
+    // unroll the ring from the oldest byte, then skip the partial record
+    size_t offset = static_cast<size_t>(header.write_pos % header.capacity);
+    std::string result = ring.substr(offset) + ring.substr(0, offset);
+    auto eol = result.find('\n');
+    result.erase(0, eol == std::string::npos ? result.size() : eol + 1);
+    return result;
+}
+
+} // namespace spdlog
@@ -71,11 +71,23 @@ SPDLOG_INLINE filename_t rotating_file_sink<Mutex>::filename()
     return file_helper_.filename();
 }
 
+template<typename Mutex>
+SPDLOG_INLINE std::FILE *rotating_file_sink<Mutex>::stream_unsafe() const
+{
+    return file_helper_.stream();
+}
+
 template<typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_it_(const details::log_msg &msg)
 {
     memory_buf_t formatted;
     base_sink<Mutex>::formatter_->format(msg, formatted);
+    sink_formatted_(msg, string_view_t(formatted.data(), formatted.size()));
+}
+
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_formatted_(const details::log_msg &, string_view_t formatted)
+{
     auto new_size = current_size_ + formatted.size();
 
     // rotate if the new estimated file size exceeds max size.
@@ -91,15 +103,65 @@ SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_it_(const details::log_msg &m
         }
     }
     file_helper_.write(formatted);
+    base_sink<Mutex>::counters_.on_write(formatted.size());
     current_size_ = new_size;
 }
 
+// format the batch into one buffer, written at once (or when a rotation is due)
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::sink_batch_(const details::log_msg *const *msgs, size_t count)
+{
+    memory_buf_t batch;
+    memory_buf_t formatted;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!base_sink<Mutex>::should_log(msgs[i]->level))
+        {
+            continue;
+        }
+        formatted.clear();
+        base_sink<Mutex>::formatter_->format(*msgs[i], formatted);
+        auto new_size = current_size_ + batch.size() + formatted.size();
+
+        // same rule as sink_it_(): rotate if the new estimated file size exceeds max size.
+        if (new_size > max_size_)
+        {
+            if (batch.size() > 0)
+            {
+                file_helper_.write(batch);
+                base_sink<Mutex>::counters_.on_write(batch.size());
+                current_size_ += batch.size();
+                batch.clear();
+            }
+            file_helper_.flush();
+            if (file_helper_.size() > 0)
+            {
+                rotate_();
+                current_size_ = 0;
+            }
+        }
+        batch.append(formatted.data(), formatted.data() + formatted.size());
+    }
+    if (batch.size() > 0)
+    {
+        file_helper_.write(batch);
+        base_sink<Mutex>::counters_.on_write(batch.size());
+        current_size_ += batch.size();
+    }
+}
+
 template<typename Mutex>
 SPDLOG_INLINE void rotating_file_sink<Mutex>::flush_()
 {
     file_helper_.flush();
 }
 
+template<typename Mutex>
+SPDLOG_INLINE void rotating_file_sink<Mutex>::sync_()
+{
+    file_helper_.sync();
+}
+
 // Rotate files:
 // log.txt -> log.1.txt
 // log.1.txt -> log.2.txt
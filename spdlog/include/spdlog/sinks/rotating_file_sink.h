@@ -26,10 +26,14 @@ public:
         const file_event_handlers &event_handlers = {});
     static filename_t calc_filename(const filename_t &filename, std::size_t index);
     filename_t filename();
+    std::FILE *stream_unsafe() const override;
 
 protected:
     void sink_it_(const details::log_msg &msg) override;
+    void sink_formatted_(const details::log_msg &msg, string_view_t formatted) override;
+    void sink_batch_(const details::log_msg *const *msgs, size_t count) override;
     void flush_() override;
+    void sync_() override;
 
 private:
     // Rotate files:
@@ -9,6 +9,10 @@
 
 #include <spdlog/common.h>
 
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 SPDLOG_INLINE bool spdlog::sinks::sink::should_log(spdlog::level::level_enum msg_level) const
 {
     return msg_level >= level_.load(std::memory_order_relaxed);
@@ -23,3 +27,74 @@ SPDLOG_INLINE spdlog::level::level_enum spdlog::sinks::sink::level() const
 {
     return static_cast<spdlog::level::level_enum>(level_.load(std::memory_order_relaxed));
 }
+
+SPDLOG_INLINE void spdlog::sinks::sink::log_batch(const details::log_msg *const *msgs, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (should_log(msgs[i]->level))
+        {
+            log(*msgs[i]);
+        }
+    }
+}
+
+SPDLOG_INLINE void spdlog::sinks::sink::sync()
+{
+    flush();
+}
+
+SPDLOG_INLINE spdlog::details::sink_stats spdlog::sinks::sink::stats() const
+{
+    return details::sink_stats{};
+}
+
+SPDLOG_INLINE std::FILE *spdlog::sinks::sink::stream_unsafe() const
+{
+    return nullptr;
+}
+
+SPDLOG_INLINE size_t spdlog::sinks::sink::formatter_id() const
+{
+    return 0;
+}
+
+SPDLOG_INLINE size_t spdlog::sinks::sink::format(const details::log_msg &, memory_buf_t &)
+{
+    return 0;
+}
+
+SPDLOG_INLINE void spdlog::sinks::sink::log_formatted(const details::log_msg &msg, size_t, string_view_t)
+{
+    log(msg);
+}
+
+SPDLOG_INLINE void spdlog::sinks::sink::log_batch_formatted(
+    const details::log_msg *const *msgs, const string_view_t *formatted, size_t count, size_t formatter_id)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (should_log(msgs[i]->level))
+        {
+            log_formatted(*msgs[i], formatter_id, formatted[i]);
+        }
+    }
+}
+
+SPDLOG_INLINE size_t spdlog::sinks::sink::formatter_id_of(const spdlog::formatter *sink_formatter)
+{
+    if (sink_formatter == nullptr)
+    {
+        return 0;
+    }
+    auto identity = sink_formatter->identity();
+    if (identity.empty())
+    {
+        return 0;
+    }
+    // ids are handed out once per identity for the life of the process
+    static std::mutex ids_mutex;
+    static std::unordered_map<std::string, size_t> ids;
+    std::lock_guard<std::mutex> lock(ids_mutex);
+    return ids.emplace(std::move(identity), ids.size() + 1).first->second;
+}
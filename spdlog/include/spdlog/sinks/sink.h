@@ -4,8 +4,11 @@
 #pragma once
 
 #include <spdlog/details/log_msg.h>
+#include <spdlog/details/telemetry.h>
 #include <spdlog/formatter.h>
 
+#include <cstdio>
+
 namespace spdlog {
 
 namespace sinks {
@@ -14,9 +17,30 @@ class SPDLOG_API sink
 public:
     virtual ~sink() = default;
     virtual void log(const details::log_msg &msg) = 0;
+    // log a batch of messages (e.g. drained at once by an async worker).
+    // each message is filtered by the sink level. default: log them one by one.
+    virtual void log_batch(const details::log_msg *const *msgs, size_t count);
     virtual void flush() = 0;
+    // flush, then make sure the data reached the storage device (fsync). default: flush().
+    virtual void sync();
     virtual void set_pattern(const std::string &pattern) = 0;
     virtual void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) = 0;
+    // bytes written, write calls and flush times so far. default: all zero (not tracked).
+    virtual details::sink_stats stats() const;
+    // crash handler support: the stdio stream the sink currently writes to, read without
+    // locking (may be stale while the sink reopens its file). default: nullptr (no stream).
+    virtual std::FILE *stream_unsafe() const;
+    // formatter sharing: sinks whose formatters have the same identity report the same id (not 0),
+    // so the logger formats a message once and hands the bytes to all of them. default: 0 (not shared).
+    virtual size_t formatter_id() const;
+    // format msg with the sink formatter, return the id of that formatter. default: 0, dest left as is.
+    virtual size_t format(const details::log_msg &msg, memory_buf_t &dest);
+    // log msg, already formatted by a formatter of the given id: sinks whose formatter still
+    // has that id write the bytes as they are. default: log(msg).
+    virtual void log_formatted(const details::log_msg &msg, size_t formatter_id, string_view_t formatted);
+    // log a batch of messages, formatted[i] holding msgs[i] formatted by a formatter of the given id.
+    // each message is filtered by the sink level. default: log_formatted() one by one.
+    virtual void log_batch_formatted(const details::log_msg *const *msgs, const string_view_t *formatted, size_t count, size_t formatter_id);
 
     void set_level(level::level_enum log_level);
     level::level_enum level() const;
@@ -25,6 +49,9 @@ public:
 protected:
     // sink log level - default is all
     level_t level_{level::trace};
+
+    // the id of the formatter identity (see formatter::identity()), 0 if it has none
+    static size_t formatter_id_of(const spdlog::formatter *sink_formatter);
 };
 
 } // namespace sinks
@@ -34,6 +34,7 @@ SPDLOG_INLINE stdout_sink_base<ConsoleMutex>::stdout_sink_base(FILE *file)
     , file_(file)
     , formatter_(details::make_unique<spdlog::pattern_formatter>())
 {
+    formatter_id_ = formatter_id_of(formatter_.get());
 #ifdef _WIN32
     // get windows handle from the FILE* object
 
@@ -57,9 +58,53 @@ SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log(const details::log_msg &m
     {
         return;
     }
+#endif // WIN32
     std::lock_guard<mutex_t> lock(mutex_);
     memory_buf_t formatted;
     formatter_->format(msg, formatted);
+    write_(string_view_t(formatted.data(), formatted.size()));
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE size_t stdout_sink_base<ConsoleMutex>::formatter_id() const
+{
+    return formatter_id_.load(std::memory_order_relaxed);
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE size_t stdout_sink_base<ConsoleMutex>::format(const details::log_msg &msg, memory_buf_t &dest)
+{
+    std::lock_guard<mutex_t> lock(mutex_);
+    formatter_->format(msg, dest);
+    return formatter_id_.load(std::memory_order_relaxed);
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log_formatted(
+    const details::log_msg &msg, size_t formatter_id, string_view_t formatted)
+{
+#ifdef _WIN32
+    if (handle_ == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+#endif // WIN32
+    std::lock_guard<mutex_t> lock(mutex_);
+    // the formatter may have been replaced since the message was formatted
+    if (formatter_id != 0 && formatter_id == formatter_id_.load(std::memory_order_relaxed))
+    {
+        write_(formatted);
+        return;
+    }
+    memory_buf_t own_formatted;
+    formatter_->format(msg, own_formatted);
+    write_(string_view_t(own_formatted.data(), own_formatted.size()));
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::write_(string_view_t formatted)
+{
+#ifdef _WIN32
     ::fflush(file_); // flush in case there is something in this file_ already
     auto size = static_cast<DWORD>(formatted.size());
     DWORD bytes_written = 0;
@@ -68,12 +113,11 @@ SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::log(const details::log_msg &m
     {
         throw_spdlog_ex("stdout_sink_base: WriteFile() failed. GetLastError(): " + std::to_string(::GetLastError()));
     }
+    counters_.on_write(formatted.size());
 #else
-    std::lock_guard<mutex_t> lock(mutex_);
-    memory_buf_t formatted;
-    formatter_->format(msg, formatted);
     ::fwrite(formatted.data(), sizeof(char), formatted.size(), file_);
     ::fflush(file_); // flush every line to terminal
+    counters_.on_write(formatted.size());
 #endif // WIN32
 }
 
@@ -81,7 +125,19 @@ template<typename ConsoleMutex>
 SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::flush()
 {
     std::lock_guard<mutex_t> lock(mutex_);
-    fflush(file_);
+    counters_.timed_flush([this] { fflush(file_); });
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE details::sink_stats stdout_sink_base<ConsoleMutex>::stats() const
+{
+    return counters_.snapshot();
+}
+
+template<typename ConsoleMutex>
+SPDLOG_INLINE std::FILE *stdout_sink_base<ConsoleMutex>::stream_unsafe() const
+{
+    return file_;
 }
 
 template<typename ConsoleMutex>
@@ -89,12 +145,14 @@ SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::set_pattern(const std::string
 {
     std::lock_guard<mutex_t> lock(mutex_);
     formatter_ = std::unique_ptr<spdlog::formatter>(new pattern_formatter(pattern));
+    formatter_id_ = formatter_id_of(formatter_.get());
 }
 
 template<typename ConsoleMutex>
 SPDLOG_INLINE void stdout_sink_base<ConsoleMutex>::set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter)
 {
     std::lock_guard<mutex_t> lock(mutex_);
+    formatter_id_ = formatter_id_of(sink_formatter.get());
     formatter_ = std::move(sink_formatter);
 }
 
@@ -6,6 +6,8 @@
 #include <spdlog/details/console_globals.h>
 #include <spdlog/details/synchronous_factory.h>
 #include <spdlog/sinks/sink.h>
+
+#include <atomic>
 #include <cstdio>
 
 #ifdef _WIN32
@@ -35,14 +37,24 @@ public:
     void set_pattern(const std::string &pattern) override;
 
     void set_formatter(std::unique_ptr<spdlog::formatter> sink_formatter) override;
+    details::sink_stats stats() const override;
+    std::FILE *stream_unsafe() const override;
+    size_t formatter_id() const override;
+    size_t format(const details::log_msg &msg, memory_buf_t &dest) override;
+    void log_formatted(const details::log_msg &msg, size_t formatter_id, string_view_t formatted) override;
 
 protected:
     mutex_t &mutex_;
     FILE *file_;
     std::unique_ptr<spdlog::formatter> formatter_;
+    std::atomic<size_t> formatter_id_{0};
+    details::sink_counters counters_;
 #ifdef _WIN32
     HANDLE handle_;
 #endif // WIN32
+
+    // write the formatted message, called with the mutex held
+    void write_(string_view_t formatted);
 };
 
 template<typename ConsoleMutex>
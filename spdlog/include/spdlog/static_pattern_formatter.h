@@ -0,0 +1,621 @@
+// Copyright(c) 2015-present, Gabi Melman & spdlog contributors.
+// Distributed under the MIT License (http://opensource.org/licenses/MIT)
+
+#pragma once
+
+//
+// Pattern formatter resolved at compile time: the pattern is a list of token types, e.g.
+//
+//   using namespace spdlog::static_pattern;
+//   // "[%H:%M:%S.%e] [%l] %v"
+//   using my_formatter = spdlog::static_pattern_formatter<text<'['>, hour, text<':'>, minute, text<':'>, second,
+//       text<'.'>, millis, text<']', ' ', '['>, level, text<']', ' '>, payload>;
+//
+// Every token is called directly (no virtual call, no op dispatch), so the compiler inlines the
+// fields, and literal text is appended with a size known at compile time.
+// Wrap a run of text and fixed width time fields in timestamp<...> to render it once per second
+// (offsets and width computed at compile time), each message then only patches the fractions:
+//
+//   using my_formatter = spdlog::static_pattern_formatter<timestamp<text<'['>, hour, text<':'>, minute,
+//       text<':'>, second, text<'.'>, millis, text<']', ' ', '['>>, level, text<']', ' '>, payload>;
+//
+// pattern() rebuilds the equivalent runtime pattern, e.g. to pick a static formatter for a
+// configured pattern string. Output is the same as pattern_formatter's for that pattern.
+//
+// A token is a default constructible type with:
+//   void format(const details::log_msg &msg, const std::tm &tm_time, memory_buf_t &dest);
+//   static void append_pattern(std::string &pattern);
+//   static const bool needs_tm; // uses tm_time (the broken down time, refreshed once per second)
+// Tokens not defined here stand for a custom flag: their pattern is "%" and the flag char, and they
+// tell the identity of that flag (see custom_flag_formatter::identity()), or the formatter has none:
+//   std::string identity() const;
+//
+
+#include <spdlog/common.h>
+#include <spdlog/details/fmt_helper.h>
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/os.h>
+#include <spdlog/formatter.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace spdlog {
+namespace static_pattern {
+
+// literal chars
+template<char... Chars>
+struct text
+{
+    static const bool needs_tm = false;
+
+    void format(const spdlog::details::log_msg &, const std::tm &, memory_buf_t &dest)
+    {
+        static const char chars[] = {Chars...};
+        dest.append(chars, chars + sizeof...(Chars));
+    }
+
+    // fixed width protocol, see timestamp
+    static const size_t width = sizeof...(Chars);
+
+    static bool write_seconds(char *out, const std::tm &)
+    {
+        static const char chars[] = {Chars...};
+        std::memcpy(out, chars, width);
+        return true;
+    }
+
+    static void write_fractions(char *, uint32_t) {}
+
+    static void append_pattern(std::string &pattern)
+    {
+        static const char chars[] = {Chars...};
+        for (char c : chars)
+        {
+            if (c == '%')
+            {
+                pattern += '%';
+            }
+            pattern += c;
+        }
+    }
+};
+
+namespace details {
+
+// a 2 digit field of the broken down time
+template<char Flag, int std::tm::*Field, int Offset = 0>
+struct tm_field
+{
+    static const bool needs_tm = true;
+
+    void format(const spdlog::details::log_msg &, const std::tm &tm_time, memory_buf_t &dest)
+    {
+        spdlog::details::fmt_helper::pad2(tm_time.*Field + Offset, dest);
+    }
+
+    static const size_t width = 2;
+
+    static bool write_seconds(char *out, const std::tm &tm_time)
+    {
+        int value = tm_time.*Field + Offset;
+        if (value < 0 || value > 99)
+        {
+            return false;
+        }
+        out[0] = static_cast<char>('0' + value / 10);
+        out[1] = static_cast<char>('0' + value % 10);
+        return true;
+    }
+
+    static void write_fractions(char *, uint32_t) {}
+
+    static void append_pattern(std::string &pattern)
+    {
+        pattern += '%';
+        pattern += Flag;
+    }
+};
+
+// fraction of a second, Width digits
+template<char Flag, typename Units, size_t Width>
+struct fraction_field
+{
+    static const bool needs_tm = false;
+
+    void format(const spdlog::details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        auto count = spdlog::details::fmt_helper::time_fraction<Units>(msg.time).count();
+        if (Width == 3)
+        {
+            spdlog::details::fmt_helper::pad3(static_cast<uint32_t>(count), dest);
+        }
+        else
+        {
+            spdlog::details::fmt_helper::pad_uint(static_cast<size_t>(count), Width, dest);
+        }
+    }
+
+    static const size_t width = Width;
+
+    static bool write_seconds(char *, const std::tm &)
+    {
+        return true;
+    }
+
+    // nanos: the fraction of the second in nanoseconds
+    static void write_fractions(char *out, uint32_t nanos)
+    {
+        std::memcpy(out, spdlog::details::fmt_helper::digits3(nanos / 1000000), 3);
+        if (Width > 3)
+        {
+            std::memcpy(out + 3, spdlog::details::fmt_helper::digits3(nanos / 1000 % 1000), 3);
+        }
+        if (Width > 6)
+        {
+            std::memcpy(out + 6, spdlog::details::fmt_helper::digits3(nanos % 1000), 3);
+        }
+    }
+
+    static void append_pattern(std::string &pattern)
+    {
+        pattern += '%';
+        pattern += Flag;
+    }
+};
+
+} // namespace details
+
+// %Y
+struct year
+{
+    static const bool needs_tm = true;
+
+    void format(const spdlog::details::log_msg &, const std::tm &tm_time, memory_buf_t &dest)
+    {
+        spdlog::details::fmt_helper::append_int(tm_time.tm_year + 1900, dest);
+    }
+
+    static const size_t width = 4;
+
+    static bool write_seconds(char *out, const std::tm &tm_time)
+    {
+        int value = tm_time.tm_year + 1900;
+        if (value < 1000 || value > 9999)
+        {
+            return false;
+        }
+        for (size_t i = width; i > 0; i--)
+        {
+            out[i - 1] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        return true;
+    }
+
+    static void write_fractions(char *, uint32_t) {}
+
+    static void append_pattern(std::string &pattern)
+    {
+        pattern += "%Y";
+    }
+};
+
+using month = details::tm_field<'m', &std::tm::tm_mon, 1>;
+using day = details::tm_field<'d', &std::tm::tm_mday>;
+using hour = details::tm_field<'H', &std::tm::tm_hour>;
+using minute = details::tm_field<'M', &std::tm::tm_min>;
+using second = details::tm_field<'S', &std::tm::tm_sec>;
+using millis = details::fraction_field<'e', std::chrono::milliseconds, 3>;
+using micros = details::fraction_field<'f', std::chrono::microseconds, 6>;
+using nanos = details::fraction_field<'F', std::chrono::nanoseconds, 9>;
+
+// %l
+struct level
+{
+    static const bool needs_tm = false;
+
+    void format(const spdlog::details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        spdlog::details::fmt_helper::append_string_view(spdlog::level::to_string_view(msg.level), dest);
+    }
+
+    static void append_pattern(std::string &pattern)
+    {
+        pattern += "%l";
+    }
+};
+
+// %L
+struct short_level
+{
+    static const bool needs_tm = false;
+
+    void format(const spdlog::details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        spdlog::details::fmt_helper::append_string_view(spdlog::level::to_short_c_str(msg.level), dest);
+    }
+
+    static void append_pattern(std::string &pattern)
+    {
+        pattern += "%L";
+    }
+};
+
+// %n
+struct logger_name
+{
+    static const bool needs_tm = false;
+
+    void format(const spdlog::details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        spdlog::details::fmt_helper::append_string_view(msg.logger_name, dest);
+    }
+
+    static void append_pattern(std::string &pattern)
+    {
+        pattern += "%n";
+    }
+};
+
+// %t
+struct thread_id
+{
+    static const bool needs_tm = false;
+
+    void format(const spdlog::details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        spdlog::details::fmt_helper::append_int(msg.thread_id, dest);
+    }
+
+    static void append_pattern(std::string &pattern)
+    {
+        pattern += "%t";
+    }
+};
+
+// %v
+struct payload
+{
+    static const bool needs_tm = false;
+
+    void format(const spdlog::details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        spdlog::details::fmt_helper::append_string_view(msg.payload, dest);
+    }
+
+    static void append_pattern(std::string &pattern)
+    {
+        pattern += "%v";
+    }
+};
+
+// %^
+struct color_start
+{
+    static const bool needs_tm = false;
+
+    void format(const spdlog::details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        msg.color_range_start = dest.size();
+    }
+
+    static void append_pattern(std::string &pattern)
+    {
+        pattern += "%^";
+    }
+};
+
+// %$
+struct color_stop
+{
+    static const bool needs_tm = false;
+
+    void format(const spdlog::details::log_msg &msg, const std::tm &, memory_buf_t &dest)
+    {
+        msg.color_range_end = dest.size();
+    }
+
+    static void append_pattern(std::string &pattern)
+    {
+        pattern += "%$";
+    }
+};
+
+template<typename... Tokens>
+struct timestamp;
+
+namespace details {
+
+template<typename Token>
+struct has_identity
+{
+    template<typename T>
+    static auto test(int) -> decltype(std::declval<const T &>().identity(), std::true_type());
+    template<typename>
+    static std::false_type test(...);
+    static const bool value = decltype(test<Token>(0))::value;
+};
+
+// the custom flags of a token by flag char, with their identity (see pattern_formatter::identity()).
+// return false if the token output can't be told apart.
+// the tokens defined here have none: their pattern tells their output
+template<typename Token, typename = void>
+struct token_identity
+{
+    static bool append(const Token &, std::map<char, std::string> &)
+    {
+        return std::is_same<Token, year>::value || std::is_same<Token, level>::value || std::is_same<Token, short_level>::value ||
+               std::is_same<Token, logger_name>::value || std::is_same<Token, thread_id>::value || std::is_same<Token, payload>::value ||
+               std::is_same<Token, color_start>::value || std::is_same<Token, color_stop>::value;
+    }
+};
+
+template<char... Chars>
+struct token_identity<text<Chars...>>
+{
+    static bool append(const text<Chars...> &, std::map<char, std::string> &)
+    {
+        return true;
+    }
+};
+
+template<char Flag, int std::tm::*Field, int Offset>
+struct token_identity<tm_field<Flag, Field, Offset>>
+{
+    static bool append(const tm_field<Flag, Field, Offset> &, std::map<char, std::string> &)
+    {
+        return true;
+    }
+};
+
+template<char Flag, typename Units, size_t Width>
+struct token_identity<fraction_field<Flag, Units, Width>>
+{
+    static bool append(const fraction_field<Flag, Units, Width> &, std::map<char, std::string> &)
+    {
+        return true;
+    }
+};
+
+template<typename... Tokens>
+struct token_identity<timestamp<Tokens...>>
+{
+    static bool append(const timestamp<Tokens...> &token, std::map<char, std::string> &flags)
+    {
+        return token.append_identity(flags);
+    }
+};
+
+template<typename Token>
+struct token_identity<Token, typename std::enable_if<has_identity<Token>::value>::type>
+{
+    static bool append(const Token &token, std::map<char, std::string> &flags)
+    {
+        std::string pattern;
+        Token::append_pattern(pattern);
+        auto identity = token.identity();
+        if (pattern.size() != 2 || pattern[0] != '%' || identity.empty())
+        {
+            return false;
+        }
+        flags[pattern[1]] = std::move(identity);
+        return true;
+    }
+};
+
+// the tokens, called one after the other (tokens may hold state, the same token may appear twice)
+template<typename... Tokens>
+struct token_list;
+
+template<>
+struct token_list<>
+{
+    static const bool needs_tm = false;
+
+    void format(const spdlog::details::log_msg &, const std::tm &, memory_buf_t &) {}
+
+    static void append_pattern(std::string &) {}
+
+    bool append_identity(std::map<char, std::string> &) const
+    {
+        return true;
+    }
+};
+
+template<typename Token, typename... Rest>
+struct token_list<Token, Rest...>
+{
+    static const bool needs_tm = Token::needs_tm || token_list<Rest...>::needs_tm;
+
+    void format(const spdlog::details::log_msg &msg, const std::tm &tm_time, memory_buf_t &dest)
+    {
+        head.format(msg, tm_time, dest);
+        tail.format(msg, tm_time, dest);
+    }
+
+    static void append_pattern(std::string &pattern)
+    {
+        Token::append_pattern(pattern);
+        token_list<Rest...>::append_pattern(pattern);
+    }
+
+    bool append_identity(std::map<char, std::string> &flags) const
+    {
+        return token_identity<Token>::append(head, flags) && tail.append_identity(flags);
+    }
+
+    Token head;
+    token_list<Rest...> tail;
+};
+
+// fixed width tokens laid out from Offset
+template<size_t Offset, typename... Tokens>
+struct fixed_layout;
+
+template<size_t Offset>
+struct fixed_layout<Offset>
+{
+    static const size_t width = 0;
+
+    static bool write_seconds(char *, const std::tm &)
+    {
+        return true;
+    }
+
+    static void write_fractions(char *, uint32_t) {}
+};
+
+template<size_t Offset, typename Token, typename... Rest>
+struct fixed_layout<Offset, Token, Rest...>
+{
+    using rest = fixed_layout<Offset + Token::width, Rest...>;
+    static const size_t width = Token::width + rest::width;
+
+    static bool write_seconds(char *out, const std::tm &tm_time)
+    {
+        return Token::write_seconds(out + Offset, tm_time) && rest::write_seconds(out, tm_time);
+    }
+
+    static void write_fractions(char *out, uint32_t nanos)
+    {
+        Token::write_fractions(out + Offset, nanos);
+        rest::write_fractions(out, nanos);
+    }
+};
+
+} // namespace details
+
+// a run of text and fixed width time fields, rendered once per second; each message appends
+// it and patches the fractions of a second. Values that don't fit (e.g. year 12345, times before
+// the epoch) are formatted token by token.
+template<typename... Tokens>
+struct timestamp
+{
+    using layout = details::fixed_layout<0, Tokens...>;
+    static const bool needs_tm = details::token_list<Tokens...>::needs_tm;
+
+    void format(const spdlog::details::log_msg &msg, const std::tm &tm_time, memory_buf_t &dest)
+    {
+        auto duration = msg.time.time_since_epoch();
+        auto secs = std::chrono::duration_cast<std::chrono::seconds>(duration);
+        if (!cached_ || secs != cached_secs_)
+        {
+            cached_ = layout::write_seconds(cached_text_, tm_time);
+            cached_secs_ = secs;
+        }
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(duration - secs).count();
+        if (!cached_ || nanos < 0)
+        {
+            tokens_.format(msg, tm_time, dest);
+            return;
+        }
+        const size_t start = dest.size();
+        dest.append(cached_text_, cached_text_ + layout::width);
+        layout::write_fractions(dest.data() + start, static_cast<uint32_t>(nanos));
+    }
+
+    static void append_pattern(std::string &pattern)
+    {
+        details::token_list<Tokens...>::append_pattern(pattern);
+    }
+
+    bool append_identity(std::map<char, std::string> &flags) const
+    {
+        return tokens_.append_identity(flags);
+    }
+
+private:
+    char cached_text_[layout::width];
+    std::chrono::seconds cached_secs_{0};
+    bool cached_ = false;
+    details::token_list<Tokens...> tokens_;
+};
+
+} // namespace static_pattern
+
+template<typename... Tokens>
+class static_pattern_formatter final : public formatter
+{
+public:
+    explicit static_pattern_formatter(
+        pattern_time_type time_type = pattern_time_type::local, std::string eol = spdlog::details::os::default_eol)
+        : time_type_(time_type)
+        , eol_(std::move(eol))
+    {
+        std::memset(&cached_tm_, 0, sizeof(cached_tm_));
+    }
+
+    static_pattern_formatter(const static_pattern_formatter &other) = delete;
+    static_pattern_formatter &operator=(const static_pattern_formatter &other) = delete;
+
+    // the equivalent runtime pattern
+    static std::string pattern()
+    {
+        std::string result;
+        tokens_type::append_pattern(result);
+        return result;
+    }
+
+    std::unique_ptr<formatter> clone() const override
+    {
+        return details::make_unique<static_pattern_formatter>(time_type_, eol_);
+    }
+
+    // the same as a pattern_formatter of the equivalent pattern, with the custom flags of the custom tokens
+    std::string identity() const override
+    {
+        std::map<char, std::string> flags;
+        if (!tokens_.append_identity(flags))
+        {
+            return std::string();
+        }
+        std::string result = pattern();
+        result += '\0';
+        result += time_type_ == pattern_time_type::local ? 'l' : 'u';
+        result += eol_;
+        for (auto &flag : flags)
+        {
+            result += '\0';
+            result += flag.first;
+            result += flag.second;
+        }
+        return result;
+    }
+
+    void format(const details::log_msg &msg, memory_buf_t &dest) override
+    {
+        if (tokens_type::needs_tm)
+        {
+            const auto secs = std::chrono::duration_cast<std::chrono::seconds>(msg.time.time_since_epoch());
+            if (!tm_cached_ || secs != last_log_secs_)
+            {
+                auto time = log_clock::to_time_t(msg.time);
+                cached_tm_ = time_type_ == pattern_time_type::local ? details::os::localtime(time) : details::os::gmtime(time);
+                last_log_secs_ = secs;
+                tm_cached_ = true;
+            }
+        }
+        tokens_.format(msg, cached_tm_, dest);
+        details::fmt_helper::append_string_view(eol_, dest);
+    }
+
+private:
+    using tokens_type = static_pattern::details::token_list<Tokens...>;
+
+    pattern_time_type time_type_;
+    std::string eol_;
+    std::tm cached_tm_;
+    std::chrono::seconds last_log_secs_{0};
+    bool tm_cached_ = false;
+    tokens_type tokens_;
+};
+
+} // namespace spdlog
@@ -132,3 +132,10 @@
 // # define SPDLOG_FUNCTION __FUNCTION__
 // #endif
 ///////////////////////////////////////////////////////////////////////////////
+
+///////////////////////////////////////////////////////////////////////////////
+// Uncomment to render timestamp digits with plain C++ instead of SSE2 on x86.
+// Other platforms always use the plain C++ code.
+//
+// #define SPDLOG_NO_SSE2
+///////////////////////////////////////////////////////////////////////////////
@@ -11,3 +11,4 @@
 #include <spdlog/details/thread_pool-inl.h>
 
 template class SPDLOG_API spdlog::details::mpmc_blocking_queue<spdlog::details::async_msg>;
+template class SPDLOG_API spdlog::details::mpmc_lockfree_queue<spdlog::details::async_msg>;
@@ -0,0 +1,66 @@
+// Processed async messages must give their byte arena blocks back right away:
+// the arena reclaims in allocation order, so a message kept in the worker's batch
+// would pin every block allocated after it.
+
+#include "test_utils.h"
+
+#include <spdlog/async_logger.h>
+#include <spdlog/details/thread_pool.h>
+
+#include <string>
+
+int main()
+{
+    // blocks of 16 + 1 + 200 bytes round up to 224: the 4096 bytes arena holds 18 messages
+    spdlog::details::thread_pool_options options;
+    options.arena_size = 4096;
+    options.batch_size = 8;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(64, 1, options);
+    auto sink = std::make_shared<gate_sink>();
+    auto logger = std::make_shared<spdlog::async_logger>("t", sink, tp, spdlog::async_overflow_policy::block);
+    const std::string payload(200, 'x');
+
+    // fill the arena while the worker is stuck on the first message
+    for (int i = 0; i < 60; i++)
+    {
+        logger->info(payload);
+    }
+    REQUIRE(tp->stats().heap_payloads > 0);
+
+    // drain it
+    sink->set_open(true);
+    sink->wait_count(60);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    REQUIRE(tp->queue_size() == 0);
+
+    // one full batch of arena backed messages, dequeued at once while the worker is stuck
+    sink->set_open(false);
+    logger->info(payload);
+    sink->wait_count(61);
+    for (int i = 0; i < 8; i++)
+    {
+        logger->info(payload);
+    }
+    sink->set_open(true);
+    sink->wait_count(69);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // the worker is stuck again with one message, the next 12 need 2688 of the 4096 bytes:
+    // they only fit if the messages of the last batch were released
+    sink->set_open(false);
+    logger->info(payload);
+    sink->wait_count(70);
+    size_t heap_before = tp->stats().heap_payloads;
+    for (int i = 0; i < 12; i++)
+    {
+        logger->info(payload);
+    }
+    REQUIRE(tp->stats().heap_payloads == heap_before);
+
+    sink->set_open(true);
+    sink->wait_count(82);
+    logger.reset();
+    tp.reset();
+    std::printf("test_async_arena: ok\n");
+    return 0;
+}
@@ -0,0 +1,120 @@
+// Batch dispatch: the worker hands the messages it drained to the sinks at once (sink::log_batch),
+// at most batch_size of them, grouped by logger, filtered by the sink level, in order.
+
+#include "test_utils.h"
+
+#include <spdlog/async_logger.h>
+#include <spdlog/details/thread_pool.h>
+#include <spdlog/sinks/sink.h>
+
+#include <atomic>
+#include <string>
+
+// implements log() only: gets the batches through the default sink::log_batch
+class plain_sink final : public spdlog::sinks::sink
+{
+public:
+    void log(const spdlog::details::log_msg &msg) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        payloads_.emplace_back(msg.payload.data(), msg.payload.size());
+    }
+
+    void flush() override {}
+    void set_pattern(const std::string &) override {}
+    void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+    std::vector<std::string> payloads()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return payloads_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::string> payloads_;
+};
+
+static void test_batches()
+{
+    spdlog::details::thread_pool_options options;
+    options.batch_size = 16;
+    auto tp = std::make_shared<spdlog::details::thread_pool>(256, 1, options);
+    auto sink = std::make_shared<gate_sink>();
+    auto logger = std::make_shared<spdlog::async_logger>("t", sink, tp, spdlog::async_overflow_policy::block);
+
+    // queue 100 messages behind a stuck one, they are drained 16 at a time
+    logger->info("stuck");
+    sink->wait_count(1);
+    for (int i = 0; i < 100; i++)
+    {
+        logger->info("{}", i);
+    }
+    size_t batches_before = sink->batches();
+    sink->set_open(true);
+    sink->wait_count(101);
+
+    REQUIRE(sink->max_batch() == 16);
+    REQUIRE(sink->batches() - batches_before == (100 + 15) / 16);
+    auto payloads = sink->payloads();
+    for (int i = 0; i < 100; i++)
+    {
+        REQUIRE(payloads[static_cast<size_t>(i) + 1] == std::to_string(i));
+    }
+    logger.reset();
+    tp.reset();
+}
+
+// a batch of two interleaved loggers: each sink gets the messages of its logger, in order
+static void test_groups_and_levels()
+{
+    auto tp = std::make_shared<spdlog::details::thread_pool>(256, 1);
+    auto stuck_sink = std::make_shared<gate_sink>();
+    auto a_sink = std::make_shared<gate_sink>(true);
+    auto b_sink = std::make_shared<plain_sink>();
+    auto stuck = std::make_shared<spdlog::async_logger>("stuck", stuck_sink, tp);
+    auto a = std::make_shared<spdlog::async_logger>("a", a_sink, tp);
+    auto b = std::make_shared<spdlog::async_logger>("b", b_sink, tp);
+    a_sink->set_level(spdlog::level::warn);
+
+    stuck->info("stuck");
+    stuck_sink->wait_count(1);
+    for (int i = 0; i < 30; i++)
+    {
+        if (i % 3 == 0)
+        {
+            a->warn("{}", i);
+        }
+        else
+        {
+            a->info("{}", i);
+        }
+        b->info("{}", i);
+    }
+    stuck_sink->set_open(true);
+    a_sink->wait_count(10);
+    REQUIRE(wait_until([&b_sink] { return b_sink->payloads().size() == 30; }));
+
+    auto a_payloads = a_sink->payloads();
+    auto b_payloads = b_sink->payloads();
+    for (int i = 0; i < 30; i++)
+    {
+        REQUIRE(b_payloads[static_cast<size_t>(i)] == std::to_string(i));
+        if (i % 3 == 0)
+        {
+            REQUIRE(a_payloads[static_cast<size_t>(i / 3)] == std::to_string(i));
+        }
+    }
+    stuck.reset();
+    a.reset();
+    b.reset();
+    tp.reset();
+}
+
+int main()
+{
+    test_batches();
+    test_groups_and_levels();
+    std::printf("test_async_batch: ok\n");
+    return 0;
+}
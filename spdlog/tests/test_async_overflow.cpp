@@ -0,0 +1,131 @@
+// Overflow policies, with every queue type: discard_new drops the new message, reserved_items keeps
+// the last slots for err and critical, drop_below_level blocks for the priority levels and drops the
+// others, overrun_oldest keeps the newest messages (per_thread: drops the new one, its producer cannot
+// evict). Drops are counted per level.
+
+#include "test_utils.h"
+
+#include <spdlog/async_logger.h>
+#include <spdlog/details/thread_pool.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+using spdlog::async_overflow_policy;
+using spdlog::details::async_queue_type;
+
+static const async_queue_type queue_types[] = {async_queue_type::blocking, async_queue_type::lockfree, async_queue_type::per_thread};
+
+struct fixture
+{
+    fixture(async_queue_type queue_type, size_t queue_size, async_overflow_policy policy, size_t reserved_items = 0)
+    {
+        spdlog::details::thread_pool_options options;
+        options.queue_type = queue_type;
+        options.reserved_items = reserved_items;
+        tp = std::make_shared<spdlog::details::thread_pool>(queue_size, 1, options);
+        sink = std::make_shared<gate_sink>();
+        logger = std::make_shared<spdlog::async_logger>("t", sink, tp, policy);
+        logger->set_level(spdlog::level::trace);
+        // the worker holds this one until the gate opens
+        logger->info("stuck");
+        sink->wait_count(1);
+    }
+
+    ~fixture()
+    {
+        sink->set_open(true);
+        logger.reset();
+        tp.reset();
+    }
+
+    std::shared_ptr<spdlog::details::thread_pool> tp;
+    std::shared_ptr<gate_sink> sink;
+    std::shared_ptr<spdlog::async_logger> logger;
+};
+
+static void test_discard_new_reserved(async_queue_type queue_type)
+{
+    fixture f(queue_type, 16, async_overflow_policy::discard_new, 4);
+    for (int i = 0; i < 20; i++)
+    {
+        f.logger->info("info {}", i);
+    }
+    REQUIRE(f.tp->queue_size() == 12);
+    REQUIRE(f.tp->dropped_counter(spdlog::level::info) == 8);
+    for (int i = 0; i < 6; i++)
+    {
+        f.logger->error("error {}", i);
+    }
+    REQUIRE(f.tp->queue_size() == 16);
+    REQUIRE(f.tp->dropped_counter(spdlog::level::err) == 2);
+    REQUIRE(f.tp->dropped_counter() == 10);
+
+    f.sink->set_open(true);
+    f.sink->wait_count(17);
+    auto payloads = f.sink->payloads();
+    REQUIRE(payloads[12] == "info 11");
+    REQUIRE(payloads[13] == "error 0");
+    REQUIRE(payloads[16] == "error 3");
+}
+
+static void test_drop_below_level(async_queue_type queue_type)
+{
+    fixture f(queue_type, 8, async_overflow_policy::drop_below_level);
+    for (int i = 0; i < 12; i++)
+    {
+        f.logger->debug("debug {}", i);
+    }
+    REQUIRE(f.tp->dropped_counter(spdlog::level::debug) == 4);
+
+    // warn is a priority level: waits for room instead of being dropped
+    std::atomic<bool> logged{false};
+    std::thread producer([&f, &logged] {
+        f.logger->warn("warn");
+        logged = true;
+    });
+    if (queue_type != async_queue_type::per_thread)
+    {
+        // (per_thread: the producer thread has a ring of its own, with room)
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        REQUIRE(!logged);
+    }
+    f.sink->set_open(true);
+    producer.join();
+    f.sink->wait_count(10);
+    REQUIRE(f.tp->dropped_counter(spdlog::level::warn) == 0);
+    REQUIRE(f.sink->payloads()[9] == "warn");
+}
+
+static void test_overrun_oldest(async_queue_type queue_type)
+{
+    fixture f(queue_type, 10, async_overflow_policy::overrun_oldest);
+    for (int i = 0; i < 30; i++)
+    {
+        f.logger->info("{}", i);
+    }
+    REQUIRE(f.tp->overrun_counter() == 20);
+    REQUIRE(f.tp->dropped_counter(spdlog::level::info) == 20);
+
+    f.sink->set_open(true);
+    f.sink->wait_count(11);
+    auto payloads = f.sink->payloads();
+    int first = queue_type == async_queue_type::per_thread ? 0 : 20;
+    for (int i = 0; i < 10; i++)
+    {
+        REQUIRE(payloads[static_cast<size_t>(i) + 1] == std::to_string(first + i));
+    }
+}
+
+int main()
+{
+    for (auto queue_type : queue_types)
+    {
+        test_discard_new_reserved(queue_type);
+        test_drop_below_level(queue_type);
+        test_overrun_oldest(queue_type);
+    }
+    std::printf("test_async_overflow: ok\n");
+    return 0;
+}
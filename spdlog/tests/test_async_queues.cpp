@@ -0,0 +1,183 @@
+// The queue types of the thread pool: every message delivered once and in order per producer,
+// queue_size is the capacity the user configured (the lockfree ring is rounded up internally),
+// and the per_thread worker merges the producer rings by log time.
+
+#include "test_utils.h"
+
+#include <spdlog/async_logger.h>
+#include <spdlog/details/mpmc_lockfree_q.h>
+#include <spdlog/details/thread_pool.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using spdlog::details::async_queue_type;
+
+static const async_queue_type queue_types[] = {async_queue_type::blocking, async_queue_type::lockfree, async_queue_type::per_thread};
+
+static std::shared_ptr<spdlog::details::thread_pool> make_pool(async_queue_type queue_type, size_t queue_size, size_t threads = 1)
+{
+    spdlog::details::thread_pool_options options;
+    options.queue_type = queue_type;
+    return std::make_shared<spdlog::details::thread_pool>(queue_size, threads, options);
+}
+
+// 4 producers, a small queue: each message once, in order per producer
+static void test_delivery(async_queue_type queue_type)
+{
+    const int producers = 4;
+    const int per_producer = 5000;
+    auto sink = std::make_shared<gate_sink>(true);
+    {
+        auto tp = make_pool(queue_type, 128);
+        auto logger = std::make_shared<spdlog::async_logger>("t", sink, tp, spdlog::async_overflow_policy::block);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < producers; t++)
+        {
+            threads.emplace_back([&logger, t] {
+                for (int i = 0; i < per_producer; i++)
+                {
+                    logger->info("{} {}", t, i);
+                }
+            });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    auto payloads = sink->payloads();
+    REQUIRE(payloads.size() == static_cast<size_t>(producers * per_producer));
+    std::vector<int> next(producers, 0);
+    for (auto &payload : payloads)
+    {
+        int t = -1, i = -1;
+        REQUIRE(std::sscanf(payload.c_str(), "%d %d", &t, &i) == 2);
+        REQUIRE(t >= 0 && t < producers);
+        REQUIRE(i == next[static_cast<size_t>(t)]);
+        next[static_cast<size_t>(t)]++;
+    }
+}
+
+// the queue holds exactly queue_size messages while the worker is stuck
+static void test_capacity(async_queue_type queue_type)
+{
+    auto sink = std::make_shared<gate_sink>();
+    auto tp = make_pool(queue_type, 10);
+    auto logger = std::make_shared<spdlog::async_logger>("t", sink, tp, spdlog::async_overflow_policy::discard_new);
+    logger->info("stuck");
+    sink->wait_count(1);
+    for (int i = 0; i < 30; i++)
+    {
+        logger->info("m {}", i);
+    }
+    REQUIRE(tp->queue_size() == 10);
+    REQUIRE(tp->dropped_counter() == 20);
+
+    sink->set_open(true);
+    sink->wait_count(11);
+    logger.reset();
+    tp.reset();
+}
+
+static void test_lockfree_queue_limits()
+{
+    // 10 is not a power of two: the ring has 16 cells, the queue holds 10 items
+    spdlog::details::mpmc_lockfree_queue<int> q(10);
+    REQUIRE(q.capacity() == 10);
+    int accepted = 0;
+    while (q.try_enqueue(int(accepted)))
+    {
+        accepted++;
+    }
+    REQUIRE(accepted == 10);
+    REQUIRE(q.size() == 10);
+
+    // a lower limit (the reserved items)
+    int item = 0;
+    REQUIRE(q.try_dequeue(item) && item == 0);
+    REQUIRE(!q.try_enqueue(42, 9));
+    REQUIRE(q.try_enqueue(42, 10));
+
+    // overrun keeps the newest 10
+    for (int i = 100; i < 150; i++)
+    {
+        q.enqueue_nowait(int(i));
+    }
+    REQUIRE(q.overrun_counter() == 50);
+    REQUIRE(q.size() == 10);
+    int items[16];
+    REQUIRE(q.try_dequeue_bulk(items, 16) == 10);
+    for (int i = 0; i < 10; i++)
+    {
+        REQUIRE(items[i] == 140 + i);
+    }
+    REQUIRE(q.size() == 0);
+}
+
+// per_thread: two threads take turns logging while the worker is stuck, so each ring holds every
+// other message. the worker must hand them out in log time order, not ring by ring.
+static void test_time_ordered_merge()
+{
+    const int per_thread = 200;
+    auto sink = std::make_shared<gate_sink>();
+    auto tp = make_pool(async_queue_type::per_thread, 1024);
+    auto logger = std::make_shared<spdlog::async_logger>("t", sink, tp, spdlog::async_overflow_policy::block);
+    logger->info("stuck");
+    sink->wait_count(1);
+
+    std::atomic<int> turn{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; t++)
+    {
+        threads.emplace_back([&logger, &turn, t] {
+            for (int i = 0; i < per_thread; i++)
+            {
+                while (turn.load() != 2 * i + t)
+                {
+                    std::this_thread::yield();
+                }
+                logger->info("{} {}", t, i);
+                turn++;
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    sink->set_open(true);
+    sink->wait_count(1 + 2 * per_thread);
+
+    auto times = sink->times();
+    for (size_t i = 1; i < times.size(); i++)
+    {
+        REQUIRE(times[i - 1] <= times[i]);
+    }
+    // taking turns: the two rings are interleaved, not drained one after the other
+    auto payloads = sink->payloads();
+    size_t switches = 0;
+    for (size_t i = 2; i < payloads.size(); i++)
+    {
+        switches += payloads[i][0] != payloads[i - 1][0] ? 1 : 0;
+    }
+    REQUIRE(switches > per_thread);
+    logger.reset();
+    tp.reset();
+}
+
+int main()
+{
+    for (auto queue_type : queue_types)
+    {
+        test_delivery(queue_type);
+        test_capacity(queue_type);
+    }
+    test_lockfree_queue_limits();
+    test_time_ordered_merge();
+    std::printf("test_async_queues: ok\n");
+    return 0;
+}
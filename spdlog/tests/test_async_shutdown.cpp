@@ -0,0 +1,132 @@
+// Bounded shutdown, with every queue type: a drained pool stops at once and loses nothing,
+// a worker stuck in a sink or a producer blocked on a full queue cannot hold shutdown() past its
+// timeout (plus the 100ms grace), and the messages of producers racing the shutdown are either
+// written or counted as dropped, never left in a queue.
+
+#include "test_utils.h"
+
+#include <spdlog/async_logger.h>
+#include <spdlog/details/thread_pool.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using spdlog::async_overflow_policy;
+using spdlog::details::async_queue_type;
+
+static const async_queue_type queue_types[] = {async_queue_type::blocking, async_queue_type::lockfree, async_queue_type::per_thread};
+
+static std::shared_ptr<spdlog::details::thread_pool> make_pool(async_queue_type queue_type, size_t queue_size, size_t threads = 1)
+{
+    spdlog::details::thread_pool_options options;
+    options.queue_type = queue_type;
+    return std::make_shared<spdlog::details::thread_pool>(queue_size, threads, options);
+}
+
+static long long elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+static void test_drain(async_queue_type queue_type)
+{
+    auto tp = make_pool(queue_type, 1024);
+    auto sink = std::make_shared<gate_sink>(true);
+    auto logger = std::make_shared<spdlog::async_logger>("t", sink, tp);
+    for (int i = 0; i < 1000; i++)
+    {
+        logger->info("{}", i);
+    }
+    REQUIRE(tp->shutdown(std::chrono::seconds(5)) == 0);
+    REQUIRE(sink->count() == 1000);
+
+    // from now on messages are dropped
+    logger->info("late");
+    REQUIRE(tp->dropped_counter() == 1);
+    REQUIRE(tp->queue_size() == 0);
+    REQUIRE(tp->shutdown(std::chrono::seconds(5)) == 0);
+    logger.reset();
+    tp.reset();
+    REQUIRE(sink->count() == 1000);
+}
+
+// the worker is stuck in the sink and a producer waits for room in the full queue
+static void test_stuck(async_queue_type queue_type)
+{
+    auto tp = make_pool(queue_type, 16);
+    auto sink = std::make_shared<gate_sink>();
+    auto logger = std::make_shared<spdlog::async_logger>("t", sink, tp, async_overflow_policy::block);
+    logger->info("stuck");
+    sink->wait_count(1);
+
+    std::atomic<int> sent{0};
+    std::thread producer([&logger, &sent] {
+        for (int i = 0; i < 40; i++)
+        {
+            logger->info("{}", i);
+            sent++;
+        }
+    });
+    REQUIRE(wait_until([&tp] { return tp->queue_size() == 16; }));
+
+    auto start = std::chrono::steady_clock::now();
+    tp->shutdown(std::chrono::milliseconds(50));
+    REQUIRE(elapsed_ms(start) < 1000);
+
+    // the stuck worker discards the rest once it is done with its message
+    sink->set_open(true);
+    producer.join();
+    REQUIRE(sent == 40);
+    REQUIRE(wait_until([&] { return sink->count() - 1 + tp->dropped_counter() == 40 && tp->queue_size() == 0; }));
+    logger.reset();
+    tp.reset();
+}
+
+static void test_late_producers(async_queue_type queue_type)
+{
+    for (int round = 0; round < 10; round++)
+    {
+        auto tp = make_pool(queue_type, 256, queue_type == async_queue_type::per_thread ? 1 : 2);
+        auto sink = std::make_shared<gate_sink>(true);
+        auto logger = std::make_shared<spdlog::async_logger>("t", sink, tp, async_overflow_policy::block);
+        std::atomic<bool> running{true};
+        std::atomic<size_t> sent{0};
+        std::vector<std::thread> producers;
+        for (int t = 0; t < 4; t++)
+        {
+            producers.emplace_back([&] {
+                while (running)
+                {
+                    logger->info("m");
+                    sent++;
+                }
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        tp->shutdown(std::chrono::milliseconds(2));
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        running = false;
+        for (auto &producer : producers)
+        {
+            producer.join();
+        }
+        // (the workers may still be discarding if shutdown() timed out)
+        REQUIRE(wait_until([&] { return tp->queue_size() == 0 && sink->count() + tp->dropped_counter() == sent; }));
+        logger.reset();
+        tp.reset();
+    }
+}
+
+int main()
+{
+    for (auto queue_type : queue_types)
+    {
+        test_drain(queue_type);
+        test_stuck(queue_type);
+        test_late_producers(queue_type);
+    }
+    std::printf("test_async_shutdown: ok\n");
+    return 0;
+}
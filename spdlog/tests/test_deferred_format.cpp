@@ -0,0 +1,125 @@
+// Deferred formatting: the caller only copies the arguments, the worker formats them.
+// The output must be the same as when the caller formats, the arguments must be copies
+// (the caller may change them right away) and a bad format string must only cost its message.
+
+#include "test_utils.h"
+
+#include <spdlog/async_logger.h>
+#include <spdlog/details/thread_pool.h>
+#include <spdlog/fmt/ostr.h>
+
+#include <atomic>
+#include <ostream>
+#include <string>
+
+struct point
+{
+    int x;
+    int y;
+};
+
+std::ostream &operator<<(std::ostream &os, const point &p)
+{
+    return os << '(' << p.x << ", " << p.y << ')';
+}
+
+#if FMT_VERSION >= 90000
+template<>
+struct fmt::formatter<point> : fmt::ostream_formatter
+{};
+#endif
+
+static void log_all(spdlog::logger &logger)
+{
+    std::string str = "a std::string";
+    const char *cstr = "a c string";
+    logger.info("{} {} {} {}", 1, -2, 3u, -4LL);
+    logger.info("{:.3f} {:e} {}", 3.14159, 1e-10, 2.5f);
+    logger.info("{} {} {}", 'c', true, false);
+    logger.info("{} [{:>12}] [{:<4}]", str, cstr, "lit");
+    logger.info("{:x} {:#o} {:08b}", 255u, 8, 5);
+    logger.info("{}", static_cast<const void *>(nullptr));
+    logger.info("{} {}", std::string(1000, 'x'), 42);
+    // not deferrable: formatted by the caller
+    logger.info("point {}", point{1, 2});
+    logger.info("no arguments");
+}
+
+static std::vector<std::string> run(bool deferred)
+{
+    auto sink = std::make_shared<gate_sink>(true);
+    auto tp = std::make_shared<spdlog::details::thread_pool>(1024, 1);
+    auto logger = std::make_shared<spdlog::async_logger>("t", sink, tp);
+    logger->set_deferred_formatting(deferred);
+    REQUIRE(logger->deferred_formatting() == deferred);
+    log_all(*logger);
+    sink->wait_count(9);
+    logger.reset();
+    tp.reset();
+    return sink->payloads();
+}
+
+static void test_same_output()
+{
+    auto immediate = run(false);
+    auto deferred = run(true);
+    REQUIRE(immediate.size() == deferred.size());
+    for (size_t i = 0; i < immediate.size(); i++)
+    {
+        REQUIRE(immediate[i] == deferred[i]);
+    }
+    REQUIRE(deferred[0] == "1 -2 3 -4");
+    REQUIRE(deferred[7] == "point (1, 2)");
+}
+
+// the worker is stuck while the caller changes its arguments
+static void test_arguments_copied()
+{
+    auto sink = std::make_shared<gate_sink>();
+    auto tp = std::make_shared<spdlog::details::thread_pool>(1024, 1);
+    auto logger = std::make_shared<spdlog::async_logger>("t", sink, tp);
+    logger->set_deferred_formatting(true);
+    logger->info("stuck");
+    sink->wait_count(1);
+
+    std::string str = "before";
+    char buf[16] = "before";
+    int value = 1;
+    logger->info("{} {} {}", str, static_cast<const char *>(buf), value);
+    str = "after";
+    std::snprintf(buf, sizeof(buf), "after");
+    value = 2;
+
+    sink->set_open(true);
+    sink->wait_count(2);
+    REQUIRE(sink->payloads()[1] == "before before 1");
+    logger.reset();
+    tp.reset();
+}
+
+static void test_format_error()
+{
+    auto sink = std::make_shared<gate_sink>(true);
+    auto tp = std::make_shared<spdlog::details::thread_pool>(1024, 1);
+    auto logger = std::make_shared<spdlog::async_logger>("t", sink, tp);
+    logger->set_deferred_formatting(true);
+    std::atomic<int> errors{0};
+    logger->set_error_handler([&errors](const std::string &) { errors++; });
+
+    logger->info(fmt::runtime("missing {} {}"), 1);
+    logger->info("after {}", "error");
+    sink->wait_count(1);
+    REQUIRE(errors == 1);
+    REQUIRE(sink->payloads()[0] == "after error");
+    logger.reset();
+    tp.reset();
+}
+
+int main()
+{
+    test_same_output();
+    test_arguments_copied();
+    test_format_error();
+    std::printf("test_deferred_format: ok\n");
+    return 0;
+}
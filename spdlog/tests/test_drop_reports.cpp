@@ -0,0 +1,101 @@
+// Drop reports (report_drops option): a logger whose messages were dropped gets a
+// "dropped N messages (...) since hh:mm:ss.mmm" warning in its sinks, before its next message,
+// and also when it logs nothing more (the worker reports it after the batch it was draining).
+
+#include "test_utils.h"
+
+#include <spdlog/async_logger.h>
+#include <spdlog/details/thread_pool.h>
+
+#include <cstring>
+#include <string>
+
+using spdlog::async_overflow_policy;
+using spdlog::details::async_queue_type;
+
+static const async_queue_type queue_types[] = {async_queue_type::blocking, async_queue_type::lockfree, async_queue_type::per_thread};
+
+static std::shared_ptr<spdlog::details::thread_pool> make_pool(async_queue_type queue_type)
+{
+    spdlog::details::thread_pool_options options;
+    options.queue_type = queue_type;
+    options.report_drops = true;
+    return std::make_shared<spdlog::details::thread_pool>(16, 1, options);
+}
+
+static bool is_report(const std::string &payload, const char *expected)
+{
+    return payload.compare(0, std::strlen(expected), expected) == 0 && payload.find(" since ") != std::string::npos;
+}
+
+// the quiet logger only logs while the queue is full: it never has a message dequeued
+static void test_quiet_logger(async_queue_type queue_type)
+{
+    auto tp = make_pool(queue_type);
+    auto noisy_sink = std::make_shared<gate_sink>();
+    auto quiet_sink = std::make_shared<gate_sink>(true);
+    auto noisy = std::make_shared<spdlog::async_logger>("noisy", noisy_sink, tp, async_overflow_policy::discard_new);
+    auto quiet = std::make_shared<spdlog::async_logger>("quiet", quiet_sink, tp, async_overflow_policy::discard_new);
+
+    noisy->info("stuck");
+    noisy_sink->wait_count(1);
+    for (int i = 0; i < 16; i++)
+    {
+        noisy->info("fill {}", i);
+    }
+    for (int i = 0; i < 5; i++)
+    {
+        quiet->info("dropped {}", i);
+    }
+    REQUIRE(tp->dropped_counter() == 5);
+
+    noisy_sink->set_open(true);
+    noisy_sink->wait_count(17);
+    quiet_sink->wait_count(1);
+    REQUIRE(is_report(quiet_sink->payloads()[0], "dropped 5 messages (queue full)"));
+    // no report for the logger that lost nothing
+    for (auto &payload : noisy_sink->payloads())
+    {
+        REQUIRE(payload.compare(0, 8, "dropped ") != 0);
+    }
+    noisy.reset();
+    quiet.reset();
+    tp.reset();
+}
+
+// the report comes before the next message of the logger, once
+static void test_report_before_next(async_queue_type queue_type)
+{
+    auto tp = make_pool(queue_type);
+    auto sink = std::make_shared<gate_sink>();
+    auto logger = std::make_shared<spdlog::async_logger>("t", sink, tp, async_overflow_policy::overrun_oldest);
+    logger->info("stuck");
+    sink->wait_count(1);
+    for (int i = 0; i < 20; i++)
+    {
+        logger->info("{}", i);
+    }
+    REQUIRE(tp->dropped_counter() == 4);
+    sink->set_open(true);
+    sink->wait_count(18);
+    logger->info("next");
+    sink->wait_count(19);
+
+    auto payloads = sink->payloads();
+    REQUIRE(is_report(payloads[1], "dropped 4 messages (overrun)"));
+    REQUIRE(payloads[2] == (queue_type == async_queue_type::per_thread ? "0" : "4"));
+    REQUIRE(payloads[18] == "next");
+    logger.reset();
+    tp.reset();
+}
+
+int main()
+{
+    for (auto queue_type : queue_types)
+    {
+        test_quiet_logger(queue_type);
+        test_report_before_next(queue_type);
+    }
+    std::printf("test_drop_reports: ok\n");
+    return 0;
+}
@@ -0,0 +1,187 @@
+// Formatter sharing: sinks with the same formatter (same pattern, flags and eol) get a message
+// formatted once by the logger, sync and async, and write the same bytes they would format
+// themselves. A sink whose formatter is replaced while the worker is busy never writes bytes of the
+// old formatter for the messages logged after set_formatter().
+
+#include "test_utils.h"
+
+#include <spdlog/async_logger.h>
+#include <spdlog/details/thread_pool.h>
+#include <spdlog/logger.h>
+#include <spdlog/pattern_formatter.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+static std::atomic<size_t> format_calls{0};
+
+// custom flag %Q counting how many times the messages were formatted
+class counting_flag final : public spdlog::custom_flag_formatter
+{
+public:
+    void format(const spdlog::details::log_msg &, const std::tm &, spdlog::memory_buf_t &dest) override
+    {
+        format_calls++;
+        dest.push_back('#');
+    }
+
+    std::unique_ptr<custom_flag_formatter> clone() const override
+    {
+        return spdlog::details::make_unique<counting_flag>();
+    }
+
+    std::string identity() const override
+    {
+        return "counting";
+    }
+};
+
+static std::unique_ptr<spdlog::formatter> make_formatter(const std::string &pattern)
+{
+    auto formatter = spdlog::details::make_unique<spdlog::pattern_formatter>();
+    formatter->add_flag<counting_flag>('Q').set_pattern(pattern);
+    return std::unique_ptr<spdlog::formatter>(formatter.release());
+}
+
+struct sinks
+{
+    sinks()
+    {
+        for (auto &sink : shared)
+        {
+            sink = std::make_shared<formatted_sink>();
+            sink->set_formatter(make_formatter("[%l] %Q%v"));
+        }
+        shared[1]->set_level(spdlog::level::warn);
+        other = std::make_shared<formatted_sink>();
+        other->set_formatter(make_formatter("%Q%v!"));
+    }
+
+    std::vector<spdlog::sink_ptr> all() const
+    {
+        return {shared[0], shared[1], shared[2], other};
+    }
+
+    std::shared_ptr<formatted_sink> shared[3];
+    std::shared_ptr<formatted_sink> other;
+};
+
+static const int n_messages = 1000;
+
+static void log_messages(spdlog::logger &logger)
+{
+    for (int i = 0; i < n_messages; i++)
+    {
+        if (i % 10 == 0)
+        {
+            logger.warn("message {}", i);
+        }
+        else
+        {
+            logger.info("message {}", i);
+        }
+    }
+}
+
+static void check_lines(sinks &s)
+{
+    std::vector<std::string> expected, expected_warn, expected_other;
+    for (int i = 0; i < n_messages; i++)
+    {
+        auto eol = spdlog::details::os::default_eol;
+        auto payload = "message " + std::to_string(i);
+        expected.push_back((i % 10 == 0 ? "[warning] #" : "[info] #") + payload + eol);
+        if (i % 10 == 0)
+        {
+            expected_warn.push_back(expected.back());
+        }
+        expected_other.push_back("#" + payload + "!" + eol);
+    }
+    REQUIRE(s.shared[0]->lines() == expected);
+    REQUIRE(s.shared[1]->lines() == expected_warn);
+    REQUIRE(s.shared[2]->lines() == expected);
+    REQUIRE(s.other->lines() == expected_other);
+
+    // the shared sinks were given the bytes, the other one formatted its messages itself
+    REQUIRE(s.shared[0]->shared_count() == static_cast<size_t>(n_messages));
+    REQUIRE(s.shared[1]->shared_count() == static_cast<size_t>(n_messages / 10));
+    REQUIRE(s.shared[2]->shared_count() == static_cast<size_t>(n_messages));
+    REQUIRE(s.other->shared_count() == 0);
+    // once for the shared sinks and once for the other one
+    REQUIRE(format_calls == static_cast<size_t>(2 * n_messages));
+}
+
+static void test_sync()
+{
+    sinks s;
+    auto all = s.all();
+    spdlog::logger logger("sync", all.begin(), all.end());
+    format_calls = 0;
+    log_messages(logger);
+    check_lines(s);
+}
+
+static void test_async()
+{
+    sinks s;
+    auto all = s.all();
+    auto tp = std::make_shared<spdlog::details::thread_pool>(n_messages + 1, 1);
+    {
+        auto logger = std::make_shared<spdlog::async_logger>("async", all.begin(), all.end(), tp);
+        format_calls = 0;
+        log_messages(*logger);
+    }
+    REQUIRE(tp->shutdown(std::chrono::seconds(5)) == 0);
+    check_lines(s);
+}
+
+// set_formatter() on one of two sharing sinks while the worker formats the batches for both
+static void test_set_formatter_race()
+{
+    auto tp = std::make_shared<spdlog::details::thread_pool>(1024, 1);
+    auto sink1 = std::make_shared<formatted_sink>();
+    auto sink2 = std::make_shared<formatted_sink>();
+    sink1->set_formatter(make_formatter("A %v"));
+    sink2->set_formatter(make_formatter("A %v"));
+    spdlog::sinks_init_list both = {sink1, sink2};
+    auto logger = std::make_shared<spdlog::async_logger>("race", both, tp, spdlog::async_overflow_policy::block);
+
+    const int half = 5000;
+    for (int i = 0; i < half; i++)
+    {
+        logger->info("{}", i);
+    }
+    sink2->set_formatter(make_formatter("B %v"));
+    for (int i = half; i < 2 * half; i++)
+    {
+        logger->info("{}", i);
+    }
+    logger.reset();
+    REQUIRE(tp->shutdown(std::chrono::seconds(5)) == 0);
+
+    auto eol = std::string(spdlog::details::os::default_eol);
+    auto lines1 = sink1->lines();
+    auto lines2 = sink2->lines();
+    REQUIRE(lines1.size() == static_cast<size_t>(2 * half));
+    REQUIRE(lines2.size() == static_cast<size_t>(2 * half));
+    bool switched = false;
+    for (int i = 0; i < 2 * half; i++)
+    {
+        auto index = static_cast<size_t>(i);
+        REQUIRE(lines1[index] == "A " + std::to_string(i) + eol);
+        // the messages queued before set_formatter() may have either formatter, once switched it stays
+        switched = switched || lines2[index][0] == 'B';
+        REQUIRE(lines2[index] == (switched ? "B " : "A ") + std::to_string(i) + eol);
+        REQUIRE(switched || i < half);
+    }
+}
+
+int main()
+{
+    test_sync();
+    test_async();
+    test_set_formatter_race();
+    std::printf("test_formatter_sharing: ok\n");
+    return 0;
+}
@@ -0,0 +1,198 @@
+// Ring sinks: mmap_ring_sink keeps the last `capacity` bytes of records in its file and
+// read_mmap_ring_file() gives them back whole, oldest first. concurrent_ringbuffer_sink keeps
+// the last messages without locking the writers, its snapshots are never torn.
+
+#include "test_utils.h"
+
+#include <spdlog/logger.h>
+#include <spdlog/sinks/concurrent_ringbuffer_sink.h>
+#ifndef _WIN32
+#    include <spdlog/sinks/mmap_ring_sink.h>
+#endif
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+static const char *ring_file = "test_logs/ring.bin";
+
+static std::string lines(int from, int to)
+{
+    std::string result;
+    for (int i = from; i < to; i++)
+    {
+        result += "line " + std::to_string(i) + "\n";
+    }
+    return result;
+}
+
+static void log_lines(const std::shared_ptr<spdlog::sinks::mmap_ring_sink_mt> &sink, int from, int to)
+{
+    spdlog::logger logger("ring", sink);
+    for (int i = from; i < to; i++)
+    {
+        logger.info("line {}", i);
+    }
+}
+
+static std::shared_ptr<spdlog::sinks::mmap_ring_sink_mt> make_ring(size_t capacity, bool truncate)
+{
+    auto sink = std::make_shared<spdlog::sinks::mmap_ring_sink_mt>(ring_file, capacity, truncate);
+    sink->set_pattern("%v");
+    return sink;
+}
+
+static void test_mmap_ring()
+{
+    uint64_t sequence = 0;
+    {
+        auto sink = make_ring(1024, true);
+        log_lines(sink, 0, 10);
+        REQUIRE(spdlog::read_mmap_ring_file(ring_file, &sequence) == lines(0, 10));
+        REQUIRE(sequence == 10);
+
+        // wrapped: the newest records, starting with a whole one
+        log_lines(sink, 10, 500);
+        std::string all = lines(0, 500);
+        std::string ring = spdlog::read_mmap_ring_file(ring_file, &sequence);
+        REQUIRE(sequence == 500);
+        REQUIRE(ring.size() <= 1024 && ring.size() > 1024 - 10);
+        REQUIRE(all.compare(all.size() - ring.size(), ring.size(), ring) == 0);
+        REQUIRE(ring.compare(0, 5, "line ") == 0);
+    }
+
+    // reopened: appended to (the records of a crashed run are kept)
+    {
+        auto sink = make_ring(1024, false);
+        log_lines(sink, 500, 502);
+        std::string ring = spdlog::read_mmap_ring_file(ring_file, &sequence);
+        REQUIRE(sequence == 502);
+        std::string tail = lines(498, 502);
+        REQUIRE(ring.compare(ring.size() - tail.size(), tail.size(), tail) == 0);
+    }
+
+    // truncated, or of another capacity: starts over
+    {
+        auto sink = make_ring(1024, true);
+        log_lines(sink, 0, 3);
+        REQUIRE(spdlog::read_mmap_ring_file(ring_file, &sequence) == lines(0, 3));
+        REQUIRE(sequence == 3);
+    }
+    {
+        auto sink = make_ring(2048, false);
+        log_lines(sink, 7, 8);
+        REQUIRE(spdlog::read_mmap_ring_file(ring_file) == lines(7, 8));
+    }
+
+    // a record larger than the ring keeps its end
+    {
+        auto sink = make_ring(16, true);
+        spdlog::logger logger("ring", sink);
+        logger.info("{}", std::string(30, 'a') + "0123456789");
+        REQUIRE(spdlog::read_mmap_ring_file(ring_file) == "aaaaa0123456789\n");
+    }
+
+    // not a ring file
+    std::FILE *file = std::fopen(ring_file, "wb");
+    REQUIRE(file != nullptr);
+    std::fputs("not a ring file, not a ring file, not a ring file, not a ring file, not a ring file", file);
+    std::fclose(file);
+    bool thrown = false;
+    try
+    {
+        spdlog::read_mmap_ring_file(ring_file);
+    }
+    catch (const spdlog::spdlog_ex &)
+    {
+        thrown = true;
+    }
+    REQUIRE(thrown);
+}
+#endif
+
+static void test_concurrent_ring_last()
+{
+    auto sink = std::make_shared<spdlog::sinks::concurrent_ringbuffer_sink>(8, 16);
+    sink->set_pattern("%v");
+    spdlog::logger logger("ring", sink);
+    for (int i = 0; i < 20; i++)
+    {
+        logger.info("{}", i);
+    }
+    auto all = sink->last_formatted();
+    REQUIRE(all.size() == 8);
+    for (size_t i = 0; i < all.size(); i++)
+    {
+        REQUIRE(all[i] == std::to_string(12 + i) + spdlog::details::os::default_eol);
+    }
+    auto last = sink->last_raw(3);
+    REQUIRE(last.size() == 3);
+    REQUIRE(std::string(last[2].payload.data(), last[2].payload.size()) == "19");
+    REQUIRE(std::string(last[2].logger_name.data(), last[2].logger_name.size()) == "ring");
+
+    // the payload is truncated to max_payload bytes
+    logger.info("{}", std::string(100, 'x'));
+    last = sink->last_raw(1);
+    REQUIRE(std::string(last[0].payload.data(), last[0].payload.size()) == std::string(16, 'x'));
+    REQUIRE(sink->dropped() == 0);
+}
+
+// readers take snapshots while writers keep logging: every message read is whole, oldest first
+static void test_concurrent_ring_snapshots()
+{
+    const int writers = 4;
+    const int per_writer = 20000;
+    auto sink = std::make_shared<spdlog::sinks::concurrent_ringbuffer_sink>(64, 64);
+    auto logger = std::make_shared<spdlog::logger>("ring", sink);
+    std::atomic<int> running{writers};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < writers; t++)
+    {
+        threads.emplace_back([&logger, &running, t] {
+            for (int i = 0; i < per_writer; i++)
+            {
+                logger->info("writer {} message {} {}", t, i, std::string(static_cast<size_t>(i % 30), '.'));
+            }
+            running--;
+        });
+    }
+
+    size_t snapshots = 0;
+    while (running > 0 || snapshots == 0)
+    {
+        auto snapshot = sink->last_raw();
+        std::vector<int> last(writers, -1);
+        for (auto &msg : snapshot)
+        {
+            std::string payload(msg.payload.data(), msg.payload.size());
+            int t = -1, i = -1;
+            REQUIRE(std::sscanf(payload.c_str(), "writer %d message %d", &t, &i) == 2);
+            REQUIRE(t >= 0 && t < writers);
+            auto expected = "writer " + std::to_string(t) + " message " + std::to_string(i) + " " + std::string(static_cast<size_t>(i % 30), '.');
+            REQUIRE(payload == expected);
+            REQUIRE(i > last[static_cast<size_t>(t)]);
+            last[static_cast<size_t>(t)] = i;
+        }
+        snapshots++;
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    // (a writer lapped before it could claim its cell drops its message)
+    size_t kept = sink->last_raw().size();
+    REQUIRE(kept <= 64 && kept + sink->dropped() >= 64);
+}
+
+int main()
+{
+#ifndef _WIN32
+    test_mmap_ring();
+#endif
+    test_concurrent_ring_last();
+    test_concurrent_ring_snapshots();
+    std::printf("test_ring_sinks: ok\n");
+    return 0;
+}
@@ -0,0 +1,148 @@
+// static_pattern_formatter must give the same bytes (and color range) as a pattern_formatter of
+// its pattern(), for local and utc time, across second, day and year boundaries and when the
+// time goes backwards, and have the same identity (custom flags included).
+
+#include "test_utils.h"
+
+#include <spdlog/pattern_formatter.h>
+#include <spdlog/static_pattern_formatter.h>
+
+#include <string>
+#include <vector>
+
+using namespace spdlog::static_pattern;
+
+// custom flag %Q, as a pattern_formatter flag and as a static token
+class q_flag final : public spdlog::custom_flag_formatter
+{
+public:
+    void format(const spdlog::details::log_msg &msg, const std::tm &, spdlog::memory_buf_t &dest) override
+    {
+        dest.push_back('<');
+        dest.append(msg.logger_name.data(), msg.logger_name.data() + msg.logger_name.size());
+        dest.push_back('>');
+    }
+
+    std::unique_ptr<custom_flag_formatter> clone() const override
+    {
+        return spdlog::details::make_unique<q_flag>();
+    }
+
+    std::string identity() const override
+    {
+        return "q";
+    }
+};
+
+struct q_token
+{
+    static const bool needs_tm = false;
+
+    void format(const spdlog::details::log_msg &msg, const std::tm &tm_time, spdlog::memory_buf_t &dest)
+    {
+        flag_.format(msg, tm_time, dest);
+    }
+
+    static void append_pattern(std::string &pattern)
+    {
+        pattern += "%Q";
+    }
+
+    std::string identity() const
+    {
+        return flag_.identity();
+    }
+
+    q_flag flag_;
+};
+
+using hms_time = timestamp<text<'['>, hour, text<':'>, minute, text<':'>, second, text<'.'>, millis, text<']', ' '>>;
+using hms = spdlog::static_pattern_formatter<hms_time, text<'['>, level, text<']', ' '>, payload>;
+using hms_color =
+    spdlog::static_pattern_formatter<hms_time, color_start, text<'['>, level, text<']'>, color_stop, text<' '>, payload>;
+using ymd = spdlog::static_pattern_formatter<timestamp<text<'['>, year, text<'-'>, month, text<'-'>, day, text<' '>, hour, text<':'>,
+                                                 minute, text<':'>, second, text<'.'>, micros, text<']'>>,
+    text<' ', '['>, logger_name, text<']', ' ', '['>, short_level, text<']', ' '>, payload, text<' '>, thread_id>;
+// fields outside a timestamp, nanoseconds, a custom token
+using loose = spdlog::static_pattern_formatter<second, text<'.'>, nanos, text<' '>, day, text<'/'>, month, text<' '>, q_token, payload>;
+
+static std::vector<spdlog::log_clock::time_point> test_times()
+{
+    using std::chrono::nanoseconds;
+    using std::chrono::seconds;
+    // 2023-12-31 23:59:59 utc
+    const spdlog::log_clock::time_point base{std::chrono::duration_cast<spdlog::log_clock::duration>(seconds(1704067199))};
+    std::vector<spdlog::log_clock::time_point> times;
+    times.push_back(base);
+    times.push_back(base + std::chrono::duration_cast<spdlog::log_clock::duration>(nanoseconds(1)));
+    times.push_back(base + std::chrono::duration_cast<spdlog::log_clock::duration>(nanoseconds(999999999)));
+    // next second, day and year
+    times.push_back(base + std::chrono::duration_cast<spdlog::log_clock::duration>(nanoseconds(1000000000)));
+    times.push_back(base + std::chrono::duration_cast<spdlog::log_clock::duration>(nanoseconds(1000123456)));
+    // back in time
+    times.push_back(base + std::chrono::duration_cast<spdlog::log_clock::duration>(nanoseconds(500000000)));
+    times.push_back(base - std::chrono::duration_cast<spdlog::log_clock::duration>(seconds(86400 * 40 + 3601)));
+    times.push_back(base + std::chrono::duration_cast<spdlog::log_clock::duration>(seconds(3600 * 5 + 61)));
+    times.push_back(spdlog::log_clock::now());
+    return times;
+}
+
+template<typename Static>
+static void check(const std::string &expected_pattern, spdlog::pattern_time_type time_type, const std::string &eol)
+{
+    REQUIRE(Static::pattern() == expected_pattern);
+    Static static_formatter(time_type, eol);
+    auto cloned = static_formatter.clone();
+    spdlog::pattern_formatter runtime_formatter(time_type, eol);
+    if (expected_pattern.find("%Q") != std::string::npos)
+    {
+        runtime_formatter.add_flag<q_flag>('Q');
+    }
+    runtime_formatter.set_pattern(Static::pattern());
+    REQUIRE(!static_formatter.identity().empty());
+    REQUIRE(static_formatter.identity() == runtime_formatter.identity());
+    REQUIRE(cloned->identity() == runtime_formatter.identity());
+
+    const char *names[] = {"", "app"};
+    const char *payloads[] = {"", "hello", "a longer message with {} braces"};
+    int n = 0;
+    for (auto time : test_times())
+    {
+        for (int lvl = 0; lvl < spdlog::level::n_levels; lvl++)
+        {
+            spdlog::details::log_msg msg(
+                time, spdlog::source_loc{}, names[n % 2], static_cast<spdlog::level::level_enum>(lvl), payloads[n % 3]);
+            n++;
+            spdlog::memory_buf_t expected, actual, actual_clone;
+            runtime_formatter.format(msg, expected);
+            size_t expected_start = msg.color_range_start, expected_end = msg.color_range_end;
+            msg.color_range_start = msg.color_range_end = 0;
+            static_formatter.format(msg, actual);
+            cloned->format(msg, actual_clone);
+            REQUIRE(fmt::to_string(actual) == fmt::to_string(expected));
+            REQUIRE(fmt::to_string(actual_clone) == fmt::to_string(expected));
+            REQUIRE(msg.color_range_start == expected_start && msg.color_range_end == expected_end);
+        }
+    }
+}
+
+template<typename Static>
+static void check_all(const std::string &expected_pattern)
+{
+    check<Static>(expected_pattern, spdlog::pattern_time_type::local, "\n");
+    check<Static>(expected_pattern, spdlog::pattern_time_type::utc, "\r\n");
+}
+
+int main()
+{
+    check_all<hms>("[%H:%M:%S.%e] [%l] %v");
+    check_all<hms_color>("[%H:%M:%S.%e] %^[%l]%$ %v");
+    check_all<ymd>("[%Y-%m-%d %H:%M:%S.%f] [%n] [%L] %v %t");
+    check_all<loose>("%S.%F %d/%m %Q%v");
+
+    // different time types or eols are different identities
+    REQUIRE(hms(spdlog::pattern_time_type::local).identity() != hms(spdlog::pattern_time_type::utc).identity());
+    REQUIRE(hms(spdlog::pattern_time_type::local, "\n").identity() != hms(spdlog::pattern_time_type::local, "\r\n").identity());
+    std::printf("test_static_formatter: ok\n");
+    return 0;
+}
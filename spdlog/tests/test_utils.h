@@ -0,0 +1,162 @@
+#pragma once
+
+// helpers shared by the tests: REQUIRE, polling and sinks that record what they get
+
+#include <spdlog/details/log_msg.h>
+#include <spdlog/sinks/base_sink.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define REQUIRE(cond)                                                                                                                      \
+    do                                                                                                                                     \
+    {                                                                                                                                      \
+        if (!(cond))                                                                                                                       \
+        {                                                                                                                                  \
+            std::fprintf(stderr, "%s:%d: REQUIRE(%s) failed\n", __FILE__, __LINE__, #cond);                                                \
+            std::exit(1);                                                                                                                  \
+        }                                                                                                                                  \
+    } while (0)
+
+// poll pred for up to 5 seconds, return its last value
+template<typename Pred>
+bool wait_until(Pred pred)
+{
+    for (int i = 0; i < 5000; i++)
+    {
+        if (pred())
+        {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return pred();
+}
+
+// records the payloads and times of the messages, blocks the worker while the gate is closed
+class gate_sink final : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    explicit gate_sink(bool open = false)
+        : open_(open)
+    {}
+
+    void set_open(bool open)
+    {
+        std::lock_guard<std::mutex> lock(gate_mutex_);
+        open_ = open;
+        gate_cv_.notify_all();
+    }
+
+    size_t count()
+    {
+        std::lock_guard<std::mutex> lock(gate_mutex_);
+        return payloads_.size();
+    }
+
+    void wait_count(size_t expected)
+    {
+        wait_until([this, expected] { return count() >= expected; });
+        REQUIRE(count() == expected);
+    }
+
+    std::vector<std::string> payloads()
+    {
+        std::lock_guard<std::mutex> lock(gate_mutex_);
+        return payloads_;
+    }
+
+    std::vector<spdlog::log_clock::time_point> times()
+    {
+        std::lock_guard<std::mutex> lock(gate_mutex_);
+        return times_;
+    }
+
+    // sink_batch_() calls so far, and the largest batch
+    size_t batches()
+    {
+        std::lock_guard<std::mutex> lock(gate_mutex_);
+        return batches_;
+    }
+
+    size_t max_batch()
+    {
+        std::lock_guard<std::mutex> lock(gate_mutex_);
+        return max_batch_;
+    }
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        std::unique_lock<std::mutex> lock(gate_mutex_);
+        payloads_.emplace_back(msg.payload.data(), msg.payload.size());
+        times_.push_back(msg.time);
+        gate_cv_.wait(lock, [this] { return open_; });
+    }
+
+    void sink_batch_(const spdlog::details::log_msg *const *msgs, size_t count) override
+    {
+        {
+            std::lock_guard<std::mutex> lock(gate_mutex_);
+            batches_++;
+            max_batch_ = count > max_batch_ ? count : max_batch_;
+        }
+        base_sink<std::mutex>::sink_batch_(msgs, count);
+    }
+
+    void flush_() override {}
+
+private:
+    std::mutex gate_mutex_;
+    std::condition_variable gate_cv_;
+    bool open_;
+    std::vector<std::string> payloads_;
+    std::vector<spdlog::log_clock::time_point> times_;
+    size_t batches_ = 0;
+    size_t max_batch_ = 0;
+};
+
+// records the formatted messages: the bytes handed over by the logger when it formatted them
+// for this sink's formatter, formatted by the sink itself otherwise
+class formatted_sink final : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    std::vector<std::string> lines()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lines_;
+    }
+
+    // messages written from bytes formatted by the logger
+    size_t shared_count()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return shared_count_;
+    }
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override
+    {
+        spdlog::memory_buf_t formatted;
+        formatter_->format(msg, formatted);
+        lines_.emplace_back(formatted.data(), formatted.size());
+    }
+
+    void sink_formatted_(const spdlog::details::log_msg &, spdlog::string_view_t formatted) override
+    {
+        lines_.emplace_back(formatted.data(), formatted.size());
+        shared_count_++;
+    }
+
+    void flush_() override {}
+
+private:
+    std::vector<std::string> lines_;
+    size_t shared_count_ = 0;
+};